@@ -3,6 +3,11 @@
 #include "../include/simulate.hpp"
 #include "../include/logger.hpp"
 #include "../include/operation.hpp"
+#include "../include/checker.hpp"
+#include "../include/damage_field.hpp"
+#include "../include/mcts.hpp"
+#include "../include/ponder.hpp"
+#include "../include/telemetry.hpp"
 
 #include <queue>
 #include <string>
@@ -14,38 +19,33 @@ constexpr bool RELEASE = true;
 constexpr bool LOG_SWITCH = false;
 constexpr bool LOG_STDOUT = false;
 constexpr int LOG_LEVEL = 0;
-
-int pid; // 玩家(我的)编号
-int ants_killed[2]; // 双方击杀蚂蚁数
-int tower_value[2]; // 双方的固定资产（不包含被EMP的）
-int avail_value[2]; // 双方的可用资产（不包含被EMP的）
-int banned_tower_count[2]; // 双方因EMP被冻结的塔数
-int banned_tower_value[2]; // 双方因EMP而不可用的固定资产
-
-int warn_streak; // 连续处于“响应状态”的回合数
-int EVA_emergency; // 因对手释放EVA而进入紧急情况的剩余回合数
-
-int reflect_limit; // 等待EMP结束，自身有足够资金进行“反射EMP攻击”的剩余回合数
-int reflecting_EMP_countdown; // 卖出全部塔后, 等待进攻模块放EMP的剩余回合数
-
-int peace_check_cd; // 距离下一次peace_check的最小回合数
-int last_attack_round = -100; // 上一次发动攻击的回合数（绝对时间）
-
-const GameInfo* info; // info的一份拷贝，用于Util等地
+constexpr bool TRACE_SWITCH = false; // 是否将对局轨迹记录到TRACE_PATH（见trace.hpp）
+constexpr const char* TRACE_PATH = "trace.bin";
+constexpr bool TELEMETRY_SWITCH = false; // 是否将各搜索块逐回合的统计写入TELEMETRY_PATH（见telemetry.hpp）
+constexpr const char* TELEMETRY_PATH = "telemetry.csv";
+constexpr const char* TELEMETRY_SUMMARY_PATH = "telemetry_summary.csv"; // 各搜索块至今的汇总，每个搜索块结束时重写
+constexpr double PREFILTER_KEEP_RATIO = 1.0; // 建塔/升级候选经伤害场（见damage_field.hpp）预筛后保留的比例，不少于1时不预筛
+constexpr bool PREFILTER_MEASURE = false; // 是否仍完整评估被预筛掉的候选，以统计预筛的召回率
+constexpr int WARM_START_K = 3; // 各搜索块保留至下一次搜索优先评估的方案数，为0时关闭热启动
+constexpr bool PONDER_SWITCH = false; // 是否在对手决策期间于后台预先评估下一次决策的候选（见ponder.hpp）。单核上会与决策争抢时间，默认关闭
+constexpr bool MCTS_SWITCH = false; // 是否以MCTS（见mcts.hpp）代替手写的搜索进行决策
+constexpr double MCTS_BUDGET_MS = 200; // MCTS每回合的墙钟时间预算（毫秒）
+constexpr int MCTS_THREADS = 0; // MCTS的线程数，为0时使用全部核心
 
 
 class Util {
     public:
     /**
      * @brief 计算到给定点的最近塔的距离，可以选择排除一个塔
+     * @param ctx 决策上下文
      * @param pos 给定的点（坐标）
      * @param exclude_id 要排除的塔id，默认不排除
      * @return int 排除exclude_id后的最近塔距离，没有塔时返回999
      */
-    static int closest_tower_dis(const Pos& pos, int exclude_id = -1) {
+    static int closest_tower_dis(const Game_context& ctx, const Pos& pos, int exclude_id = -1) {
         int ans = 999;
-        for (const Tower& t : info->towers) {
-            if (t.player != pid || t.id == exclude_id) continue;
+        for (const Tower& t : ctx.info->towers) {
+            if (t.player != ctx.pid || t.id == exclude_id) continue;
             ans = std::min(ans, distance(t.x, t.y, pos.x, pos.y));
         }
         return ans;
@@ -73,23 +73,25 @@ class Util {
 
     /**
      * @brief 计算在给定点释放EMP后，被屏蔽的塔数量
+     * @param ctx 决策上下文
      * @param pos 释放EMP的坐标
      * @param player_id 被EMP攻击的玩家编号
      * @return int 被屏蔽的塔数量
      */
-    static int EMP_tower_count(const Pos& pos, int player_id) {
-        return std::count_if(info->towers.begin(), info->towers.end(), [&](const Tower& t){ return t.player == player_id && distance(t.x, t.y, pos.x, pos.y) <= EMP_RANGE; });
+    static int EMP_tower_count(const Game_context& ctx, const Pos& pos, int player_id) {
+        return std::count_if(ctx.info->towers.begin(), ctx.info->towers.end(), [&](const Tower& t){ return t.player == player_id && distance(t.x, t.y, pos.x, pos.y) <= EMP_RANGE; });
     }
     /**
      * @brief 计算在给定点释放EMP后，被屏蔽的钱数
+     * @param ctx 决策上下文
      * @param pos 释放EMP的坐标
      * @param player_id 被EMP攻击的玩家编号
      * @return int 被屏蔽的钱数
      */
-    static int EMP_banned_money(const Pos& pos, int player_id) { // 【可能需要debug，见#3942719】
+    static int EMP_banned_money(const Game_context& ctx, const Pos& pos, int player_id) { // 【可能需要debug，见#3942719】
         int ans = 0;
         int banned_count = 0;
-        for (const Tower& t : info->towers) {
+        for (const Tower& t : ctx.info->towers) {
             if (t.player != player_id || distance(t.x, t.y, pos.x, pos.y) > EMP_RANGE) continue;
             banned_count++;
             ans += TOWER_REFUND[banned_count] + LEVEL_REFUND[t.level()];
@@ -108,16 +110,16 @@ class Util {
     }
     /**
      * @brief 检查新的塔是否有可能与其它塔同时被EMP覆盖，可以选择排除一个塔
+     * @param ctx 决策上下文
      * @param new_tower 新塔的坐标
      * @param exclude_id 要排除的塔id，默认不排除
      * @return bool 判定的结果 
      */
-    static bool EMP_can_cover(const Pos& new_tower, int exclude_id = -1) {
-        for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
-            if (distance(x, y, new_tower.x, new_tower.y) > EMP_RANGE) continue;
-            for (const Tower& t : info->towers) if (t.player == pid && distance(x, y, t.x, t.y) <= EMP_RANGE && t.id != exclude_id) return true;
-        }
-        return false;
+    static bool EMP_can_cover(const Game_context& ctx, const Pos& new_tower, int exclude_id = -1) {
+        // 即新塔与其它塔的EMP范围是否相交
+        Cell_set others;
+        for (const Tower& t : ctx.info->towers) if (t.player == ctx.pid && t.id != exclude_id) others |= super_weapon_area(t.x, t.y, EMP_RANGE);
+        return (super_weapon_area(new_tower.x, new_tower.y, EMP_RANGE) & others).any();
     }
 
 };
@@ -125,13 +127,25 @@ class Util {
 class AI_ {
     public:
         Logger logger;
-        AI_() : logger(RELEASE, LOG_SWITCH, LOG_STDOUT, LOG_LEVEL) {}
+        /**
+         * @brief 构造AI，每局对局应使用新的AI_实例
+         * @param quiet 是否关闭stderr上的日志（用于批量自对弈）
+         */
+        explicit AI_(bool quiet = false) : logger(RELEASE && !quiet, LOG_SWITCH, LOG_STDOUT, LOG_LEVEL) {}
 
         // 游戏过程控制及预处理
         void run_ai() {
             Controller c;
             std::vector<Operation> _opponent_op; // 对手上一次的行动，仅在保证其值正确的时候传递给ai_call_routine
 
+            // 对局轨迹
+            Trace_writer trace;
+            if (TRACE_SWITCH && trace.open(TRACE_PATH, c.self_player_id)) {
+                c.trace = &trace;
+                trace.record_state(c.info);
+            }
+            if (TELEMETRY_SWITCH) telemetry.open(TELEMETRY_PATH, TELEMETRY_SUMMARY_PATH);
+
             // 初始化距离数组
             init_dist_array(); 
             while (true) {
@@ -142,24 +156,29 @@ class AI_ {
                     for (auto &op : ops) c.append_self_operation(op);
                     // Send operations to judger
                     c.send_self_operations();
+                    // 对手决策期间的预搜索
+                    if (PONDER_SWITCH) ponder.start(prediction->info, c.self_player_id, get_sim_round(prediction->info.round));
                     // Apply operations to game state
                     c.apply_self_operations();
                     // Read opponent operations from judger
                     c.read_opponent_operations();
+                    if (!std::cin) return; // 输入结束（如重放录制的输入）
                     _opponent_op = c.get_opponent_operations();
                     // Apply opponent operations to game state
                     c.apply_opponent_operations();
-                    // Parallel Simulation
-                    Simulator fixer(c.info, pid);
-                    fixer.next_round();
+                    // 结算预测：对方未操作时沿用决策后的预测，否则在实际局面上重新结算
+                    if (_opponent_op.size()) resettle_prediction(c.info);
+                    trace.record_prediction(prediction->info);
                     // Read round info from judger
                     c.read_round_info();
+                    if (!std::cin) return;
                     // Overwrite incorrect Tower::cd and Ant::evasion!
-                    pre_fix_cd(fixer, c.info);
-                    pre_fix_evasion(fixer, c.info);
+                    pre_fix_cd(*prediction, c.info);
+                    pre_fix_evasion(*prediction, c.info);
                 } else  { // Game process when you are player 1
                     // Read opponent operations from judger
                     c.read_opponent_operations();
+                    if (!std::cin) return; // 输入结束（如重放录制的输入）
                     _opponent_op = c.get_opponent_operations();
                     // Apply opponent operations to game state
                     c.apply_opponent_operations();
@@ -169,24 +188,26 @@ class AI_ {
                     for (auto &op : ops) c.append_self_operation(op);
                     // Send operations to judger
                     c.send_self_operations();
+                    // 对手决策期间的预搜索
+                    if (PONDER_SWITCH) ponder.start(prediction->info, c.self_player_id, get_sim_round(prediction->info.round));
                     // Apply operations to game state
                     c.apply_self_operations();
-                    // Parallel Simulation
-                    Simulator fixer(c.info, pid);
-                    fixer.next_round();
+                    // 决策后的预测即为本回合的结算结果
+                    trace.record_prediction(prediction->info);
                     // Read round info from judger
                     c.read_round_info();
+                    if (!std::cin) return;
                     // Overwrite incorrect Tower::cd and Ant::evasion!
-                    pre_fix_cd(fixer, c.info);
-                    pre_fix_evasion(fixer, c.info);
+                    pre_fix_cd(*prediction, c.info);
+                    pre_fix_evasion(*prediction, c.info);
                 }
             }
         }
         // 预处理模块：覆盖错误的Tower::cd
         void pre_fix_cd(const Simulator& fixer, GameInfo& incorrect) {
             bool id_same = true;
-            const std::vector<Tower>& correct_tower = fixer.info.towers;
-            std::vector<Tower>& editing_tower = incorrect.towers;
+            const auto& correct_tower = fixer.info.towers;
+            auto& editing_tower = incorrect.towers;
             assert(correct_tower.size() == editing_tower.size());
             for (int i = 0, lim = correct_tower.size(); i < lim; i++) id_same &= (correct_tower[i].id == editing_tower[i].id);
             if (!id_same) {
@@ -202,8 +223,8 @@ class AI_ {
         // 预处理模块：覆盖错误的Ant::evasion
         void pre_fix_evasion(const Simulator& fixer, GameInfo& incorrect) {
             bool id_same = true;
-            const std::vector<Ant>& correct_ant = fixer.info.ants;
-            std::vector<Ant>& editing_ant = incorrect.ants;
+            const auto& correct_ant = fixer.info.ants;
+            auto& editing_ant = incorrect.ants;
             assert(correct_ant.size() == editing_ant.size());
             for (int i = 0, lim = correct_ant.size(); i < lim; i++) id_same &= (correct_ant[i].id == editing_ant[i].id);
             if (!id_same) {
@@ -220,9 +241,10 @@ class AI_ {
 
         // 决策逻辑
         const std::vector<Operation>& ai_call_routine(int player_id, const GameInfo &game_info, const std::vector<Operation>& opponent_op) {
-            // 全局变量
-            pid = player_id;
-            info = &game_info;
+            // 决策上下文
+            ctx.pid = player_id;
+            ctx.info = &game_info;
+            ctx.cache = PONDER_SWITCH ? ponder.finish(game_info, player_id) : nullptr;
 
             // 初始化
             ops.clear();
@@ -246,12 +268,12 @@ class AI_ {
             for (int i = 0; i < 2; i++) avail_value[i] = tower_value[i] + game_info.coins[i];
 
             // 例行Log
-            std::string disp = str_wrap("HP:%2d/%2d   ", game_info.bases[pid].hp, game_info.bases[!pid].hp);
-            disp += str_wrap("Kill:%2d/%2d   ", ants_killed[pid], ants_killed[!pid]);
-            disp += str_wrap("Money: %3d (%3dC + %3dT", tower_value[pid] + game_info.coins[pid], game_info.coins[pid], tower_value[pid]);
-            if (banned_tower_value[pid]) disp += str_wrap(" + %dU", banned_tower_value[pid]);
-            disp += str_wrap(") vs %3d (%3dC + %3dT", tower_value[!pid] + game_info.coins[!pid], game_info.coins[!pid], tower_value[!pid]);
-            if (banned_tower_value[!pid]) disp += str_wrap(" + %dU", banned_tower_value[!pid]);
+            std::string disp = str_wrap("HP:%2d/%2d   ", game_info.bases[ctx.pid].hp, game_info.bases[!ctx.pid].hp);
+            disp += str_wrap("Kill:%2d/%2d   ", ants_killed[ctx.pid], ants_killed[!ctx.pid]);
+            disp += str_wrap("Money: %3d (%3dC + %3dT", tower_value[ctx.pid] + game_info.coins[ctx.pid], game_info.coins[ctx.pid], tower_value[ctx.pid]);
+            if (banned_tower_value[ctx.pid]) disp += str_wrap(" + %dU", banned_tower_value[ctx.pid]);
+            disp += str_wrap(") vs %3d (%3dC + %3dT", tower_value[!ctx.pid] + game_info.coins[!ctx.pid], game_info.coins[!ctx.pid], tower_value[!ctx.pid]);
+            if (banned_tower_value[!ctx.pid]) disp += str_wrap(" + %dU", banned_tower_value[!ctx.pid]);
             logger.err(disp + ')');
 
             // SuperWeapon log
@@ -272,100 +294,139 @@ class AI_ {
             if (opponent_op.size()) logger.err(enemy_op);
 
             // 主决策逻辑
-            ai_main(game_info, opponent_op); // 暂时维持原本的传参模式
+            if (MCTS_SWITCH) mcts_main(game_info);
+            else ai_main(game_info, opponent_op); // 暂时维持原本的传参模式
+
+            // 操作重排序（须在预测之前，与实际执行的顺序一致）
+            std::sort(ops.begin(), ops.end(), [](const Operation& a, const Operation& b){return a.type == DowngradeTower && b.type != DowngradeTower;});
 
             // 模拟检查
             ai_simulation_checker_pos(game_info);
 
-            // 操作重排序
-            std::sort(ops.begin(), ops.end(), [](const Operation& a, const Operation& b){return a.type == DowngradeTower && b.type != DowngradeTower;});
+            // 预搜索的结果只用于本次决策
+            ctx.cache = nullptr;
 
             // Simulator/Ant log
             int max_age = -1;
             const Ant* oldest = NULL;
-            for (const Ant& a : game_info.ants) if (a.player == pid && a.age > max_age) {
+            for (const Ant& a : game_info.ants) if (a.player == ctx.pid && a.age > max_age) {
                 oldest = &a;
                 max_age = a.age;
             }
 
-            logger.err("Sim:%d Round:%d,  Max age %d %s",
-                Simulator::sim_count - last_sim_count, Simulator::round_count - last_round_count, max_age, oldest ? oldest->str(true).c_str() : "");
-            last_sim_count = Simulator::sim_count;
-            last_round_count = Simulator::round_count;
+            logger.err("Sim:%d Round:%d Hit:%d,  Max age %d %s",
+                ctx.sim_count - last_sim_count, ctx.round_count - last_round_count, ctx.cache_hits - last_cache_hits, max_age, oldest ? oldest->str(true).c_str() : "");
+            last_sim_count = ctx.sim_count;
+            last_round_count = ctx.round_count;
+            last_cache_hits = ctx.cache_hits;
 
             return ops;
         }
 
     private:
-        std::string pred;
+        Game_context ctx; // 决策上下文，供Operation_list及Simulator使用
+
+        int ants_killed[2] = {}; // 双方击杀蚂蚁数
+        int tower_value[2] = {}; // 双方的固定资产（不包含被EMP的）
+        int avail_value[2] = {}; // 双方的可用资产（不包含被EMP的）
+        int banned_tower_count[2] = {}; // 双方因EMP被冻结的塔数
+        int banned_tower_value[2] = {}; // 双方因EMP而不可用的固定资产
+
+        int warn_streak = 0; // 连续处于“响应状态”的回合数
+        int EVA_emergency = 0; // 因对手释放EVA而进入紧急情况的剩余回合数
+
+        int reflect_limit = 0; // 等待EMP结束，自身有足够资金进行“反射EMP攻击”的剩余回合数
+        int reflecting_EMP_countdown = 0; // 卖出全部塔后, 等待进攻模块放EMP的剩余回合数
+
+        int peace_check_cd = 0; // 距离下一次peace_check的最小回合数
+        int last_attack_round = -100; // 上一次发动攻击的回合数（绝对时间）
+
+        // 跨回合热启动：各搜索块记录上一次评估最好的若干方案，下一次优先评估，尽早得到较强的当前最优解
+        enum Search_block { AWARE_BUILD, PEACE_BUILD, SEARCH_BLOCK_COUNT };
+        struct Warm_start {
+            int next_tower_id = 0; // 记录时的next_tower_id，用于将新建塔的编号映射到当前局面
+            std::vector<std::vector<Task>> plans; // 按评估结果从好到坏
+        } warm_start[SEARCH_BLOCK_COUNT];
+
+        int prefilter_checks = 0; // 统计预筛召回率时，有最优候选的搜索次数
+        int prefilter_hits = 0; // 其中最优候选未被预筛掉的次数
+
+        Ponder ponder; // 对手决策期间的后台预搜索
+        Search_telemetry telemetry; // 仅在TELEMETRY_SWITCH时打开
+        std::optional<Mcts> mcts; // 仅在MCTS_SWITCH时使用，首次决策时构造
+
+        std::optional<Simulator> prediction; // 上一次决策后对下一次决策时局面的预测
+        uint64_t prediction_hash = 0;
+        std::optional<GameInfo> presettle; // 先手方：执行我方操作后、对方行动前的预测局面，供对方行动后重新结算
+        bool prediction_resettled = false; // 先手方：prediction是否已在对方行动后的实际局面上重新结算
         int last_sim_count = 0;
         int last_round_count = 0;
-        // 模拟检查：检查Simulator对一回合后的预测结果是否与实测符合
+        int last_cache_hits = 0;
+        // 模拟检查：检查Simulator对一回合后的预测结果是否与实测符合，仅在哈希不一致时输出逐字段的差异
         void ai_simulation_checker_pre(const GameInfo &game_info, const std::vector<Operation>& opponent_op) {
-            std::string cur;
-            for (const Ant& a : game_info.ants) cur += a.str(true);
-            if (cur != pred && game_info.round > 0) {
-                if (opponent_op.size()) {
-                    logger.err("Predition and truth differ for round %d (opponent act)", game_info.round);
-                    return;
-                } else logger.err("[w] Predition and truth differ for round %d", game_info.round);
-                logger.err("Pred: " + pred);
-                logger.err("Truth:" + cur);
-
-                std::string tow = "Towers: ";
-                for (const Tower& t : game_info.towers) tow += t.str(true);
-                logger.err(tow);
+            if (!prediction || game_info.round == 0) return;
+            // 先手方的预测须包含对方上回合的操作，运行流程未重新结算时（如进程内对局）在此补上
+            if (ctx.pid == 0 && opponent_op.size() && !prediction_resettled && presettle) {
+                Simulator& s = prediction.emplace(ctx, *presettle, ctx.pid);
+                for (int i = 0; i < 2; i++) s.info.bases[i].hp = presettle->bases[i].hp;
+                s.operations[!ctx.pid] = opponent_op;
+                s.apply_operations_of_player(!ctx.pid);
+                s.next_round();
+                prediction_hash = state_hash(s.info);
+            }
+            if (state_hash(game_info) == prediction_hash) return;
+            // 后手方决策时的局面已包含对方本回合的操作，预测无从包含
+            if (ctx.pid == 1 && opponent_op.size()) {
+                logger.err("Predition and truth differ for round %d (opponent act)", game_info.round);
+                return;
+            }
+            logger.err("[w] Predition and truth differ for round %d", game_info.round);
+            std::string diff = state_diff(prediction->info, game_info);
+            for (size_t pos = 0, next; pos < diff.size(); pos = next + 1) {
+                next = diff.find('\n', pos);
+                logger.err(diff.substr(pos, next - pos));
             }
         }
-        // 模拟检查：检查Simulator对一回合后的预测结果是否与实测符合，同时预测Ants_killed
+        // 模拟检查：预测本回合结算后的局面（假设对方不操作），同时预测Ants_killed
+        // 结算后的局面同时供模拟检查、预处理模块及预搜索使用，下一回合先手方的行动不影响state_hash，无需推演
         void ai_simulation_checker_pos(const GameInfo &game_info) {
-            Simulator s(game_info, pid);
+            Simulator& s = prediction.emplace(ctx, game_info, ctx.pid);
+            for (int i = 0; i < 2; i++) s.info.bases[i].hp = game_info.bases[i].hp; // 以真实血量预测，供轨迹记录
             // s.verbose = 1;
-            if (pid == 0) {
-                // Add player0's operation
-                for (const Operation& op : ops) s.operations[0].push_back(op);
-                // Apply player0's operation
-                s.apply_operations_of_player(0);
-                // Add player1's operation
-                // Apply player1's operation
-                s.apply_operations_of_player(1);
-                // Next round
-                s.next_round();
-            } else {
-                // Add player1's operation
-                for (const Operation& op : ops) s.operations[1].push_back(op);
-                // Apply player1's operation
-                s.apply_operations_of_player(1);
-                // Next round
-                s.next_round();
-                // Add player0's operation
-                // Apply player0's operation
-                s.apply_operations_of_player(0);
-            }
-            pred = "";
-            for (const Ant& a : s.info.ants) pred += a.str(true);
+            // 执行我方操作，随后依行动顺序推进：本回合后手方行动、结算
+            s.operations[ctx.pid] = ops;
+            s.apply_operations_of_player(ctx.pid);
+            if (ctx.pid == 0) presettle = s.info;
+            prediction_resettled = false;
+            for (int p = ctx.pid + 1; p < 2; p++) s.apply_operations_of_player(p);
+            s.next_round();
+            prediction_hash = state_hash(s.info);
 
             // 更新ants_killed的预测值
             for (int i = 0; i < 2; i++) ants_killed[i] += s.ants_killed[i];
         }
 
-        // 主决策逻辑
-        void ai_main(const GameInfo &game_info, const std::vector<Operation>& opponent_op) {
-            // 公共变量
-            int sim_round = get_sim_round(game_info.round);
-            int tower_num = game_info.tower_num_of_player(pid);
+        // 在双方均已行动的实际局面上重新结算本回合（用于先手方得知对方操作之后）
+        void resettle_prediction(const GameInfo& settling) {
+            Simulator& s = prediction.emplace(ctx, settling, ctx.pid);
+            for (int i = 0; i < 2; i++) s.info.bases[i].hp = settling.bases[i].hp;
+            s.next_round();
+            prediction_hash = state_hash(s.info);
+            prediction_resettled = true;
+        }
 
-            // 处理计划任务
+        // 执行到期的计划任务，返回是否执行了任何任务
+        bool conduct_scheduled(const GameInfo &game_info) {
             bool conducted = false;
             while (schedule_queue.size() && schedule_queue.top() <= game_info.round) {
                 Task task = schedule_queue.top();
                 schedule_queue.pop();
 
-                if (!game_info.is_operation_valid(pid, task.op)) {
+                if (!game_info.is_operation_valid(ctx.pid, task.op)) {
                     logger.err("[w] Discard invalid operation %s", task.op.str(true).c_str());
                     continue;
                 }
-                int cost = -game_info.get_operation_income(pid, task.op);
+                int cost = -game_info.get_operation_income(ctx.pid, task.op);
                 if (avail_money - cost < 0) {
                     logger.err("[w] Discard operation %s, cost %d > %d", task.op.str(true).c_str(), cost, avail_money);
                     continue;
@@ -376,26 +437,55 @@ class AI_ {
                 avail_money -= cost;
                 logger.err("Conduct scheduled task: %s", task.op.str(true).c_str());
             }
-            if (conducted) return;
+            return conducted;
+        }
+
+        // 以MCTS（见mcts.hpp）代替手写搜索的决策逻辑
+        void mcts_main(const GameInfo &game_info) {
+            if (!mcts) {
+                Mcts_cfg cfg;
+                cfg.budget_ms = MCTS_BUDGET_MS;
+                cfg.threads = MCTS_THREADS;
+                mcts.emplace(ctx.pid, cfg);
+            }
+            if (conduct_scheduled(game_info)) { // 执行的并非搜索选出的动作，子树不再适用
+                mcts->reset();
+                return;
+            }
+            Mcts_result res = mcts->search(game_info);
+            std::string choice;
+            for (const Task& t : res.ops) choice += ' ' + t.op.str(true) + (t.round ? str_wrap("(+%d)", t.round) : "");
+            logger.err("MCTS: it %d, visits %d, value %.3f%s, choice:%s", res.iterations, res.visits, res.value, res.reused ? ", reused" : "", choice.c_str());
+            append_task_list(game_info, res.ops);
+        }
+
+        // 主决策逻辑
+        void ai_main(const GameInfo &game_info, const std::vector<Operation>& opponent_op) {
+            // 公共变量
+            int sim_round = get_sim_round(game_info.round);
+            int tower_num = game_info.tower_num_of_player(ctx.pid);
+
+            // 处理计划任务
+            if (conduct_scheduled(game_info)) return;
 
             // raw results
-            Operation_list raw_result({}, sim_round);
+            Operation_list raw_result(ctx, {}, sim_round);
             Operation_list best_result(raw_result);
             int raw_f_succ = raw_result.res.first_succ;
 
             // status flags
             bool EMP_active = std::any_of(game_info.super_weapons.begin(), game_info.super_weapons.end(),
-                    [&](const SuperWeapon& sup){return sup.player != pid && sup.type == SuperWeaponType::EmpBlaster;});
+                    [&](const SuperWeapon& sup){return sup.player != ctx.pid && sup.type == SuperWeaponType::EmpBlaster;});
             bool DFL_active = std::any_of(game_info.super_weapons.begin(), game_info.super_weapons.end(),
-                [&](const SuperWeapon& sup){return sup.player != pid && sup.type == SuperWeaponType::Deflector;});
+                [&](const SuperWeapon& sup){return sup.player != ctx.pid && sup.type == SuperWeaponType::Deflector;});
             bool aware_status = (raw_f_succ < 20) && (reflecting_EMP_countdown <= 0);
             bool warning_status = EMP_active || DFL_active || EVA_emergency > 0 || raw_f_succ <= 10;
-            bool peace_check = (avail_money >= 130 || avail_value[pid] >= 250) && (raw_f_succ >= 40);
-            peace_check &= (raw_result.res.next_old <= 20 && game_info.bases[pid].hp >= game_info.bases[!pid].hp) || (raw_result.res.first_enc <= 20);
+            bool peace_check = (avail_money >= 130 || avail_value[ctx.pid] >= 250) && (raw_f_succ >= 40);
+            peace_check &= (raw_result.res.next_old <= 20 && game_info.bases[ctx.pid].hp >= game_info.bases[!ctx.pid].hp) || (raw_result.res.first_enc <= 20);
 
-            bool hp_draw = (game_info.bases[pid].hp == game_info.bases[!pid].hp); // 血量是否打平
+            bool hp_draw = (game_info.bases[ctx.pid].hp == game_info.bases[!ctx.pid].hp); // 血量是否打平
 
-            int enemy_base_level = game_info.bases[!pid].ant_level;
+            int enemy_base_level = game_info.bases[!ctx.pid].ant_level;
             peace_check &= (enemy_base_level < 2);
             peace_check &= (peace_check_cd <= 0) || (game_info.round >= 500);
             peace_check_cd--;
@@ -412,24 +502,31 @@ class AI_ {
             if (reflecting_EMP_countdown > 0) situation_log += str_wrap(", try to EMP: %d", reflecting_EMP_countdown);
             logger.err(situation_log);
 
-            int atk_start_time = Simulator::round_count;
+            int atk_start_time = ctx.round_count;
             if (game_info.round >= 12) {
                 if (aware_status) { // 如果啥事不干基地会扣血
                     // 搜索：（拆除+）建塔/升级
-                    Op_generator build_gen(game_info, pid, avail_money);
+                    Op_generator build_gen(game_info, ctx.pid, avail_money);
                     if (warning_status) build_gen << Sell_cfg{3, 3};
                     build_gen.generate_operations();
-
-                    for (const Defense_operation& op_list : build_gen.ops) {
+                    telemetry.begin("aware_build", ctx, build_gen.ops.size());
+                    std::vector<bool> kept = prefilter(game_info, build_gen.ops);
+                    Defence_baseline baseline(ctx, sim_round);
+                    int best_idx = -1;
+                    std::vector<Operation_list> top;
+
+                    for (int i : warm_order(AWARE_BUILD, game_info, build_gen.ops)) {
+                        const Defense_operation& op_list = build_gen.ops[i];
+                        if (!kept[i] && !PREFILTER_MEASURE) continue;
                         if (game_info.round + op_list.round_needed >= MAX_ROUND) continue;
 
                         std::optional<Pos> build_pos;
                         for (const Task& t : op_list.ops) if (t.op.type == OperationType::BuildTower) build_pos = {t.op.arg0, t.op.arg1};
-                        assert(!build_pos || is_highland(pid, build_pos.value().x, build_pos.value().y));
+                        assert(!build_pos || is_highland(ctx.pid, build_pos.value().x, build_pos.value().y));
 
-                        Operation_list opl({}, -1, op_list.loss, op_list.cost, !pid);
+                        Operation_list opl(ctx, {}, -1, op_list.loss, op_list.cost, !ctx.pid);
                         opl.ops = op_list.ops;
-                        opl.evaluate(sim_round, best_result.res.first_succ);
+                        opl.evaluate(sim_round, best_result.res.first_succ, &baseline);
 
                         // 判定修建后是否“在任何时刻都能放出LS”
                         if (opl.res.first_succ > EMP_COVER_PENALTY) {
@@ -437,55 +534,77 @@ class AI_ {
                             if (min_avail < 150) opl.max_f_succ = EMP_COVER_PENALTY + 5 * (double(min_avail) / 150);
                         }
 
-                        if (opl > best_result) {
+                        settle_contender(opl, i, best_result, best_idx, top, sim_round, baseline);
+                        telemetry.candidate(opl.res);
+                        record_warm(top, opl);
+                        if (better_candidate(opl, i, best_result, best_idx)) {
+                            telemetry.best(opl.res, i);
                             logger.err((build_pos ? "bud: " : "upd: ") + opl.defence_str());
                             best_result = opl;
+                            best_idx = i;
                         }
                     }
+                    telemetry.end(ctx, game_info.round);
+                    save_warm(AWARE_BUILD, game_info, top);
+                    record_prefilter(kept, best_idx);
 
                     // 紧急处理：EMP
                     constexpr SuperWeaponType LS(SuperWeaponType::LightningStorm);
                     constexpr int LS_cost = SUPER_WEAPON_INFO[LS][3];
-                    if ((raw_f_succ <= EMP_HANDLE_THRESH || warn_streak > 4) && EMP_active && game_info.super_weapon_cd[pid][LS] <= 0) {
-                        Op_generator gen(game_info, pid, avail_money);
+                    if ((raw_f_succ <= EMP_HANDLE_THRESH || warn_streak > 4) && EMP_active && game_info.super_weapon_cd[ctx.pid][LS] <= 0) {
+                        Op_generator gen(game_info, ctx.pid, avail_money);
                         gen << Sell_cfg{3, 3} << Build_cfg{false} << Upgrade_cfg{0} << LS_cfg{true};
                         gen.generate_operations();
+                        telemetry.begin("emp_ls", ctx, gen.ops.size());
 
-                        for (const Defense_operation& op_list : gen.ops) {
-                            Operation_list opl({}, -1, op_list.loss, op_list.cost, !pid);
+                        for (int i = 0; i < gen.ops.size(); i++) {
+                            const Defense_operation& op_list = gen.ops[i];
+                            Operation_list opl(ctx, {}, -1, op_list.loss, op_list.cost, !ctx.pid);
                             opl.ops = op_list.ops;
                             opl.evaluate(sim_round);
+                            telemetry.candidate(opl.res);
 
                             if (opl > raw_result) logger.err("LS:   " + opl.defence_str());
-                            if (opl > best_result) best_result = opl;
+                            if (opl > best_result) {
+                                telemetry.best(opl.res, i);
+                                best_result = opl;
+                            }
                         }
+                        telemetry.end(ctx, game_info.round);
                     }
                 } else if (peace_check) { // 和平时期检查
                     // 是否需要承接末期LS的使命
-                    bool no_ls = (avail_value[pid] < 130) || (game_info.round + game_info.super_weapon_cd[pid][SuperWeaponType::LightningStorm] >= MAX_ROUND);
+                    bool no_ls = (avail_value[ctx.pid] < 130) || (game_info.round + game_info.super_weapon_cd[ctx.pid][SuperWeaponType::LightningStorm] >= MAX_ROUND);
 
                     // 搜索：（拆除+）建塔/升级
-                    Op_generator build_gen(game_info, pid, avail_money);
+                    Op_generator build_gen(game_info, ctx.pid, avail_money);
                     build_gen.sell.tweaking = true;
                     if (game_info.round <= 493 || !no_ls) {
                         build_gen.build.lv3_options.clear();
                         build_gen.upgrade.max_count = 1;
                     }
                     build_gen.generate_operations();
-
-                    for (const Defense_operation& op_list : build_gen.ops) {
+                    telemetry.begin("peace_build", ctx, build_gen.ops.size());
+                    std::vector<bool> kept = prefilter(game_info, build_gen.ops);
+                    Defence_baseline baseline(ctx, sim_round);
+                    int best_idx = -1;
+                    std::vector<Operation_list> top;
+
+                    for (int i : warm_order(PEACE_BUILD, game_info, build_gen.ops)) {
+                        const Defense_operation& op_list = build_gen.ops[i];
+                        if (!kept[i] && !PREFILTER_MEASURE) continue;
                         if (game_info.round + op_list.round_needed >= MAX_ROUND) continue;
 
                         std::optional<Pos> build_pos;
                         for (const Task& t : op_list.ops) if (t.op.type == OperationType::BuildTower) build_pos = {t.op.arg0, t.op.arg1};
-                        assert(!build_pos || is_highland(pid, build_pos.value().x, build_pos.value().y));
+                        assert(!build_pos || is_highland(ctx.pid, build_pos.value().x, build_pos.value().y));
 
                         if (game_info.round <= 493 && op_list.cost > 60) continue;
                         if (game_info.round > 493 && op_list.cost > 120 && !no_ls) continue;
 
-                        Operation_list opl({}, -1, op_list.loss, op_list.cost, !pid);
+                        Operation_list opl(ctx, {}, -1, op_list.loss, op_list.cost, !ctx.pid);
                         opl.ops = op_list.ops;
-                        opl.evaluate(sim_round, best_result.res.first_succ);
+                        opl.evaluate(sim_round, best_result.res.first_succ, &baseline);
 
                         // 判定修建后是否“在任何时刻都能放出LS”
                         if (opl.res.first_succ > EMP_COVER_PENALTY) {
@@ -493,19 +612,29 @@ class AI_ {
                             if (min_avail < 150) opl.max_f_succ = EMP_COVER_PENALTY + 5 * (double(min_avail) / 150);
                         }
 
+                        settle_contender(opl, i, best_result, best_idx, top, sim_round, baseline);
                         if (!opl.res.early_stop && opl > raw_result) logger.err((build_pos ? "p_bud: " : "p_upd: ") + opl.defence_str());
-                        if (opl > best_result) best_result = opl;
+                        telemetry.candidate(opl.res);
+                        record_warm(top, opl);
+                        if (better_candidate(opl, i, best_result, best_idx)) {
+                            telemetry.best(opl.res, i);
+                            best_result = opl;
+                            best_idx = i;
+                        }
                     }
+                    telemetry.end(ctx, game_info.round);
+                    save_warm(PEACE_BUILD, game_info, top);
+                    record_prefilter(kept, best_idx);
                 }
                 // reflect
-                if (best_result.res.first_succ == 0 && EMP_active && avail_value[!pid] <= 100) reflect_limit = 50;
+                if (best_result.res.first_succ == 0 && EMP_active && avail_value[!ctx.pid] <= 100) reflect_limit = 50;
                 else reflect_limit--;
             }
 
             // Reflect EMP
             reflecting_EMP_countdown--;
-            if (reflect_limit > 0 && avail_value[pid] >= 170) {
-                Op_generator sell_gen(game_info, pid, avail_money);
+            if (reflect_limit > 0 && avail_value[ctx.pid] >= 170) {
+                Op_generator sell_gen(game_info, ctx.pid, avail_money);
                 sell_gen << Sell_cfg{10, 3};
                 sell_gen.generate_sell_list();
                 best_result.ops = sell_gen.sell_list.back().ops;
@@ -523,7 +652,7 @@ class AI_ {
                 }
 
                 bool occupying_LS = EMP_active && best_result.res.first_succ <= raw_f_succ + 20
-                    && (avail_money + tower_value[pid] > 150 && avail_money + tower_value[pid] - best_result.cost <= 150)
+                    && (avail_money + tower_value[ctx.pid] > 150 && avail_money + tower_value[ctx.pid] - best_result.cost <= 150)
                     && !std::any_of(best_result.ops.begin(), best_result.ops.end(), [](const Task& sc){return sc.op.type == UseLightningStorm;});
                 if (occupying_LS) logger.err("[Occupying LS, result not taken]");
                 else append_task_list(game_info, best_result.ops);
@@ -531,35 +660,40 @@ class AI_ {
             }
 
             // 是否进入到“卷击杀数”的状态
-            bool consider_old = (game_info.bases[pid].hp == game_info.bases[!pid].hp) && (ants_killed[pid] < ants_killed[!pid] + 3);
+            bool consider_old = (game_info.bases[ctx.pid].hp == game_info.bases[!ctx.pid].hp) && (ants_killed[ctx.pid] < ants_killed[!ctx.pid] + 3);
 
             // 进攻搜索：EVA
             // 总体思想：尽量2~3回合内打到对面基地，减少对方反应时间
             int last_atk = game_info.round - last_attack_round;
-            Operation_list EVA_raw({}, EVA_SIM_ROUND, -1), best_EVA(EVA_raw);
+            Operation_list EVA_raw(ctx, {}, EVA_SIM_ROUND, -1), best_EVA(EVA_raw);
             constexpr SuperWeaponType EVA(SuperWeaponType::EmergencyEvasion);
 
-            bool EVA_economy_crit = (avail_money >= 210) || (game_info.coins[!pid] <= 130 && avail_money >= 160 + 50 * game_info.bases[!pid].ant_level);
-            if (game_info.super_weapon_cd[pid][EVA] <= 0 && last_atk > 5 && avail_value[pid] >= 150) if (raw_f_succ >= 30) {
-                Op_generator EVA_gen(game_info, pid, avail_money);
+            bool EVA_economy_crit = (avail_money >= 210) || (game_info.coins[!ctx.pid] <= 130 && avail_money >= 160 + 50 * game_info.bases[!ctx.pid].ant_level);
+            if (game_info.super_weapon_cd[ctx.pid][EVA] <= 0 && last_atk > 5 && avail_value[ctx.pid] >= 150) if (raw_f_succ >= 30) {
+                Op_generator EVA_gen(game_info, ctx.pid, avail_money);
                 EVA_gen << Sell_cfg{3, 3} << Build_cfg{false} << Upgrade_cfg{0} << EVA_cfg{true};
                 EVA_gen.generate_operations();
+                telemetry.begin("eva", ctx, EVA_gen.ops.size());
 
                 // “模拟对方防守”的结果与我方如何sell塔无关，所以可以解耦出来
+                // 各位置的模拟共用一个Simulator，每次模拟后以撤销日志恢复到初始局面
                 Pos last_EVA_pos = {-1, -1};
+                std::optional<Simulator> EVA_probe;
+                Undo_log EVA_undo;
                 bool defended = false;
                 bool old_defended = false;
 
                 for (const Defense_operation& EVA_list : EVA_gen.ops) {
-                    if (Simulator::round_count - atk_start_time > 160000) {// 硬卡时间
+                    if (ctx.round_count - atk_start_time > 160000) {// 硬卡时间
                         logger.err("[w] EVA search time out");
                         break;
                     }
                     if (game_info.round + EVA_list.round_needed >= MAX_ROUND) continue;
 
-                    Operation_list opl({}, -1, EVA_list.loss, EVA_list.cost);
+                    Operation_list opl(ctx, {}, -1, EVA_list.loss, EVA_list.cost);
                     opl.ops = EVA_list.ops;
                     opl.evaluate(20); // 用于判定拆完塔之后是不是安全的
+                    telemetry.candidate(opl.res);
 
                     // 进攻效果判据
                     bool old_cond = hp_draw && (opl.res.old_opp > EVA_raw.res.old_opp);
@@ -569,7 +703,7 @@ class AI_ {
                     if (opl.res.first_succ < MAX_ROUND) continue;
 
                     // 部分经济要求判据
-                    int min_avail = min_avail_money_under_EMP(game_info, EVA_list) * (game_info.super_weapon_cd[pid][SuperWeaponType::LightningStorm] <= 0);
+                    int min_avail = min_avail_money_under_EMP(game_info, EVA_list) * (game_info.super_weapon_cd[ctx.pid][SuperWeaponType::LightningStorm] <= 0);
                     if (!(EVA_economy_crit || min_avail >= 160)) continue;
 
                     // 假如该位置的EVA还没模拟过，则模拟对方防守
@@ -577,20 +711,23 @@ class AI_ {
                     if (last_EVA_pos != curr_EVA_pos) {
                         last_EVA_pos = curr_EVA_pos;
 
-                        Simulator raw_sim(game_info, pid, pid);
+                        if (!EVA_probe) EVA_probe.emplace(ctx, game_info, ctx.pid, ctx.pid).undo = &EVA_undo;
+                        Simulator& raw_sim = *EVA_probe;
+                        int probe_start = raw_sim.mark();
                         raw_sim.step_simulation(EVA_list.round_needed);
-                        raw_sim.task_list[pid].emplace_back(EVA_list.ops.back()); // 对对方而言，我方是否Sell塔并不是很重要
-                        raw_sim.info.coins[pid] = 999; // 所以作点弊也没关系...
+                        raw_sim.task_list[ctx.pid].emplace_back(EVA_list.ops.back()); // 对对方而言，我方是否Sell塔并不是很重要
+                        EVA_undo.save(raw_sim.info.coins[ctx.pid]);
+                        raw_sim.info.coins[ctx.pid] = 999; // 所以作点弊也没关系...
                         raw_sim.step_to_next_player();
 
-                        Op_generator generator(raw_sim.info, !pid);
+                        Op_generator generator(raw_sim.info, !ctx.pid);
                         generator.generate_operations();
 
                         defended = false;
                         old_defended = false;
                         for (const Defense_operation& op_list : generator.ops) {
-                            Simulator atk_sim(raw_sim.info, !pid, pid);
-                            atk_sim.task_list[!pid] = op_list.ops;
+                            Simulator atk_sim(ctx, raw_sim.info, !ctx.pid, ctx.pid);
+                            atk_sim.task_list[!ctx.pid] = op_list.ops;
                             Sim_result res = atk_sim.simulate(EVA_SIM_ROUND, EVA_SIM_ROUND);
 
                             if (res.old_opp < opl.res.old_opp) old_defended = true;
@@ -600,15 +737,23 @@ class AI_ {
                                 break;
                             }
                         }
+                        raw_sim.task_list[ctx.pid].clear(); // 未到时间的任务留在了task_list中
+                        raw_sim.rollback(probe_start);
                     }
 
                     // 如果（对方）未找到解，则更新答案
                     if (!defended) {
                         logger.err("Not solved EVA %s", opl.attack_str().c_str());
-                        if (opl.attack_better_than(best_EVA, consider_old)) best_EVA = opl;
+                        if (opl.attack_better_than(best_EVA, consider_old)) {
+                            telemetry.best(opl.res, &EVA_list - EVA_gen.ops.data());
+                            best_EVA = opl;
+                        }
                     } else if (consider_old && old_cond && !old_defended) {
                         logger.err("EVA attack for old %s", opl.attack_str().c_str());
-                        if (opl.attack_better_than(best_EVA, consider_old)) best_EVA = opl;
+                        if (opl.attack_better_than(best_EVA, consider_old)) {
+                            telemetry.best(opl.res, &EVA_list - EVA_gen.ops.data());
+                            best_EVA = opl;
+                        }
                     }
                 }
                 logger.err("raw best_EVA: %s (scanned %d)", best_EVA.attack_str().c_str(), EVA_gen.ops.size());
@@ -635,38 +780,44 @@ class AI_ {
                         last_atk = 0;
                     }
                 }
+                telemetry.end(ctx, game_info.round);
             }
 
 
             // 进攻搜索：EMP
             // 总体思想：我不着急，钱足够多，对面放不出LS（钱不够多或冷却中）
-            Operation_list EMP_raw({}, EMP_SIM_ROUND), best_EMP(EMP_raw);
+            Operation_list EMP_raw(ctx, {}, EMP_SIM_ROUND), best_EMP(EMP_raw);
             constexpr SuperWeaponType EB = SuperWeaponType::EmpBlaster;
 
             bool reflect_tag = reflecting_EMP_countdown >= 0;
-            bool op_ls_ready = game_info.super_weapon_cd[!pid][SuperWeaponType::LightningStorm] <= 0;
+            bool op_ls_ready = game_info.super_weapon_cd[!ctx.pid][SuperWeaponType::LightningStorm] <= 0;
             bool EMP_economy_crit = !op_ls_ready || reflect_tag || (avail_money >= 200);
-            if (game_info.super_weapon_cd[pid][EB] <= 0 && last_atk > 5 && avail_value[pid] >= 210) if (raw_f_succ >= 40 || reflect_tag) {
-                Op_generator EMP_gen(game_info, pid, avail_money);
+            if (game_info.super_weapon_cd[ctx.pid][EB] <= 0 && last_atk > 5 && avail_value[ctx.pid] >= 210) if (raw_f_succ >= 40 || reflect_tag) {
+                Op_generator EMP_gen(game_info, ctx.pid, avail_money);
                 EMP_gen << Sell_cfg{2, 3} << Build_cfg{false} << Upgrade_cfg{0} << EMP_cfg{true};
                 EMP_gen.generate_operations();
+                telemetry.begin("emp", ctx, EMP_gen.ops.size());
 
                 // “模拟对方防守”的结果与我方如何sell塔无关，所以可以解耦出来
+                // 各位置的模拟共用一个Simulator，每次模拟后以撤销日志恢复到初始局面
                 Pos last_EMP_pos = {-1, -1};
+                std::optional<Simulator> EMP_probe;
+                Undo_log EMP_undo;
                 bool ls_defended = false;
                 bool build_defended = false;
                 bool old_defended = false;
 
                 for (const Defense_operation& EMP_list : EMP_gen.ops) {
-                    if (Simulator::round_count - atk_start_time > 170000) {// 硬卡时间
+                    if (ctx.round_count - atk_start_time > 170000) {// 硬卡时间
                         logger.err("[w] EMP search time out");
                         break;
                     }
                     if (game_info.round + EMP_list.round_needed >= MAX_ROUND) continue;
 
-                    Operation_list opl({}, -1, EMP_list.loss, EMP_list.cost);
+                    Operation_list opl(ctx, {}, -1, EMP_list.loss, EMP_list.cost);
                     opl.ops = EMP_list.ops;
                     opl.evaluate(20); // 用于判定拆完塔之后是不是安全的
+                    telemetry.candidate(opl.res);
 
                     // 进攻效果判据
                     bool dmg_cond = opl.res.dmg_dealt > EMP_raw.res.dmg_dealt && opl.res.dmg_dealt > 2;
@@ -677,7 +828,7 @@ class AI_ {
                     if (opl.res.first_succ < MAX_ROUND) continue;
 
                     // 部分经济要求判据
-                    int min_avail = min_avail_money_under_EMP(game_info, {opl.ops}) * (game_info.super_weapon_cd[pid][SuperWeaponType::LightningStorm] <= 0);
+                    int min_avail = min_avail_money_under_EMP(game_info, {opl.ops}) * (game_info.super_weapon_cd[ctx.pid][SuperWeaponType::LightningStorm] <= 0);
                     if (!(EMP_economy_crit || min_avail >= 160)) continue;
 
                     // 假如该位置的EMP还没模拟过，则模拟对方防守
@@ -685,13 +836,16 @@ class AI_ {
                     if (last_EMP_pos != curr_EMP_pos) {
                         last_EMP_pos = curr_EMP_pos;
 
-                        Simulator raw_sim(game_info, pid, pid);
+                        if (!EMP_probe) EMP_probe.emplace(ctx, game_info, ctx.pid, ctx.pid).undo = &EMP_undo;
+                        Simulator& raw_sim = *EMP_probe;
+                        int probe_start = raw_sim.mark();
                         raw_sim.step_simulation(EMP_list.round_needed);
-                        raw_sim.task_list[pid].emplace_back(EMP_list.ops.back()); // 对对方而言，我方是否Sell塔并不是很重要
-                        raw_sim.info.coins[pid] = 999; // 所以作点弊也没关系...
+                        raw_sim.task_list[ctx.pid].emplace_back(EMP_list.ops.back()); // 对对方而言，我方是否Sell塔并不是很重要
+                        EMP_undo.save(raw_sim.info.coins[ctx.pid]);
+                        raw_sim.info.coins[ctx.pid] = 999; // 所以作点弊也没关系...
                         raw_sim.step_to_next_player();
 
-                        Op_generator generator(raw_sim.info, !pid);
+                        Op_generator generator(raw_sim.info, !ctx.pid);
                         generator << LS_cfg{true};
                         generator.generate_operations();
 
@@ -701,8 +855,8 @@ class AI_ {
                         for (const Defense_operation& op_list : generator.ops) {
                             if (ls_defended && op_list.has_ls()) continue;
 
-                            Simulator atk_sim(raw_sim.info, !pid, pid);
-                            atk_sim.task_list[!pid] = op_list.ops;
+                            Simulator atk_sim(ctx, raw_sim.info, !ctx.pid, ctx.pid);
+                            atk_sim.task_list[!ctx.pid] = op_list.ops;
                             Sim_result res = atk_sim.simulate(EMP_SIM_ROUND, EMP_SIM_ROUND);
 
                             if (res.old_opp < opl.res.old_opp) old_defended = true;
@@ -713,28 +867,40 @@ class AI_ {
                                 if (build_defended) break;
                             }
                         }
+                        raw_sim.task_list[ctx.pid].clear(); // 未到时间的任务留在了task_list中
+                        raw_sim.rollback(probe_start);
                     }
 
                     if (reflect_tag && opl.attack_better_than(best_EMP, consider_old)) {
                         logger.err("Possible reflect EMP %s", opl.attack_str().c_str());
+                        telemetry.best(opl.res, &EMP_list - EMP_gen.ops.data());
                         best_EMP = opl;
                     } else if (ls_defended && !build_defended) { // （对方）只找到LS解
                         logger.err("%s solved by LS", opl.attack_str().c_str());
-                        if (opl.attack_better_than(best_EMP, consider_old)) best_EMP = opl;
+                        if (opl.attack_better_than(best_EMP, consider_old)) {
+                            telemetry.best(opl.res, &EMP_list - EMP_gen.ops.data());
+                            best_EMP = opl;
+                        }
                     } else if (!ls_defended && !build_defended) { // （对方）未找到解
                         logger.err("Not solved EMP %s", opl.attack_str().c_str());
                         opl.res.dmg_dealt += 100; // 标记为“不可解”
-                        if (opl.attack_better_than(best_EMP, consider_old)) best_EMP = opl;
+                        if (opl.attack_better_than(best_EMP, consider_old)) {
+                            telemetry.best(opl.res, &EMP_list - EMP_gen.ops.data());
+                            best_EMP = opl;
+                        }
                     } else if (consider_old && old_cond && !old_defended) { // 未找到“防止老死”的解
                         logger.err("EMP Attack for old %s", opl.attack_str().c_str());
-                        if (opl.attack_better_than(best_EMP, consider_old)) best_EMP = opl;
+                        if (opl.attack_better_than(best_EMP, consider_old)) {
+                            telemetry.best(opl.res, &EMP_list - EMP_gen.ops.data());
+                            best_EMP = opl;
+                        }
                     }
                 }
                 logger.err("raw best_EMP: " + best_EMP.attack_str());
 
                 bool unsolved_trigger = (best_EMP.res.dmg_dealt > 100);
-                bool force_ls_trigger = (avail_value[pid] - avail_value[!pid] >= 150);
-                force_ls_trigger |= (avail_money >= 250 && avail_value[pid] >= 300);
+                bool force_ls_trigger = (avail_value[ctx.pid] - avail_value[!ctx.pid] >= 150);
+                force_ls_trigger |= (avail_money >= 250 && avail_value[ctx.pid] >= 300);
                 force_ls_trigger |= game_info.round > 450;
                 if (best_EMP.res.dmg_dealt > EMP_raw.res.dmg_dealt && (unsolved_trigger || force_ls_trigger || reflect_tag)) {
                     // 不可解，或己方经济有优势时挤压对方
@@ -765,14 +931,15 @@ class AI_ {
                         if (reflect_tag) reflecting_EMP_countdown = 0;
                     }
                 }
+                telemetry.end(ctx, game_info.round);
             }
 
 
             // 随缘升基地
             // 事实证明，打开这个功能则打eve/MoebiusMeow战绩很好，关闭这个功能则打omegafantasy战绩很好
-            int base_level = game_info.bases[pid].ant_level;
-            bool draw_cond = (game_info.bases[pid].hp <= game_info.bases[!pid].hp) && (ants_killed[pid] <= ants_killed[!pid]);
-            bool money_cond = (avail_money >= 200 + 50 * base_level) && (avail_value[pid] >= 300 + 50 * base_level) && (base_level < 2);
+            int base_level = game_info.bases[ctx.pid].ant_level;
+            bool draw_cond = (game_info.bases[ctx.pid].hp <= game_info.bases[!ctx.pid].hp) && (ants_killed[ctx.pid] <= ants_killed[!ctx.pid]);
+            bool money_cond = (avail_money >= 200 + 50 * base_level) && (avail_value[ctx.pid] >= 300 + 50 * base_level) && (base_level < 2);
             if (money_cond) money_cond &= (min_avail_money_under_EMP(game_info, {{Task(Operation(UpgradeGeneratedAnt))}}) >= 150);
             if (game_info.round < 480 && draw_cond && money_cond && !ops.size()) {
                 logger.err("[Upgrading base]");
@@ -782,24 +949,31 @@ class AI_ {
 
 
             // 末回合进行LS
-            Operation_list final_LS_raw({}, sim_round), best_final_LS(final_LS_raw);
+            Operation_list final_LS_raw(ctx, {}, sim_round), best_final_LS(final_LS_raw);
             constexpr SuperWeaponType LS(SuperWeaponType::LightningStorm);
             constexpr int LS_cost = SUPER_WEAPON_INFO[LS][3];
-            if (hp_draw && game_info.round >= 505 && game_info.super_weapon_cd[pid][LS] <= 0) {
-                Op_generator gen(game_info, pid, avail_money);
+            if (hp_draw && game_info.round >= 505 && game_info.super_weapon_cd[ctx.pid][LS] <= 0) {
+                Op_generator gen(game_info, ctx.pid, avail_money);
                 gen << Sell_cfg{3, 3} << Build_cfg{false} << Upgrade_cfg{0} << LS_cfg{true};
                 gen.generate_operations();
+                telemetry.begin("final_ls", ctx, gen.ops.size());
 
-                for (const Defense_operation& op_list : gen.ops) {
+                for (int i = 0; i < gen.ops.size(); i++) {
+                    const Defense_operation& op_list = gen.ops[i];
                     if (game_info.round + op_list.round_needed >= MAX_ROUND) continue;
 
-                    Operation_list opl({}, -1, op_list.loss, op_list.cost, !pid);
+                    Operation_list opl(ctx, {}, -1, op_list.loss, op_list.cost, !ctx.pid);
                     opl.ops = op_list.ops;
                     opl.evaluate(sim_round);
+                    telemetry.candidate(opl.res);
 
                     if (opl > final_LS_raw) logger.err("Terminal LS:   " + opl.defence_str());
-                    if (opl > best_final_LS) best_final_LS = opl;
+                    if (opl > best_final_LS) {
+                        telemetry.best(opl.res, i);
+                        best_final_LS = opl;
+                    }
                 }
+                telemetry.end(ctx, game_info.round);
 
                 bool better_cond = !best_final_LS.res.succ_ant && (best_final_LS > final_LS_raw);
                 bool solved_cond = better_cond && !best_final_LS.res.old_ant;
@@ -812,17 +986,80 @@ class AI_ {
 
         }
 
+        // 候选的评估顺序：上一次的最优方案（映射塔编号后）若仍在候选之中则排在最前，其余保持原顺序
+        std::vector<int> warm_order(Search_block block, const GameInfo& game_info, const std::vector<Defense_operation>& cands) const {
+            std::vector<int> order;
+            std::vector<bool> used(cands.size());
+            const Warm_start& warm = warm_start[block];
+            for (std::vector<Task> plan : warm.plans) {
+                for (Task& t : plan)
+                    if (t.op.type == UpgradeTower && t.op.arg0 >= warm.next_tower_id) t.op.arg0 += game_info.next_tower_id - warm.next_tower_id;
+                for (int i = 0; i < cands.size(); i++) {
+                    if (used[i] || !std::equal(plan.begin(), plan.end(), cands[i].ops.begin(), cands[i].ops.end(), [](const Task& a, const Task& b) {
+                        return a.round == b.round && a.op.type == b.op.type && a.op.arg0 == b.op.arg0 && a.op.arg1 == b.op.arg1;
+                    })) continue;
+                    order.push_back(i);
+                    used[i] = true;
+                    break;
+                }
+            }
+            for (int i = 0; i < cands.size(); i++) if (!used[i]) order.push_back(i);
+            return order;
+        }
+        // 第i个候选opl是否应取代当前最优（第best_idx个候选，-1表示不操作）；结果相同时取下标较小者
+        static bool better_candidate(const Operation_list& opl, int i, const Operation_list& best, int best_idx) {
+            return opl > best || (best_idx > i && !(best > opl));
+        }
+        /**
+         * @brief 提前停止的候选若可能取代当前最优或进入热启动列表，则完整重新评估
+         * @note 提前停止时first_succ是准确的，但danger_encounter、old_ant、succ_ant只统计到停止为止，
+         *       其比较结果不劣于完整评估；据此不能胜出的候选完整评估后也不能胜出。
+         *       因此最终选择与完整评估每个候选相同，不受热启动调整的搜索顺序影响
+         */
+        static void settle_contender(Operation_list& opl, int i, const Operation_list& best, int best_idx,
+                const std::vector<Operation_list>& top, int sim_round, const Defence_baseline& baseline) {
+            if (!opl.res.early_stop) return;
+            bool warm = WARM_START_K > 0 && (top.size() < WARM_START_K || opl > top.back());
+            if (warm || better_candidate(opl, i, best, best_idx)) opl.evaluate(sim_round, -1, &baseline);
+        }
+        // 将opl计入本次搜索评估最好的WARM_START_K个方案
+        static void record_warm(std::vector<Operation_list>& top, const Operation_list& opl) {
+            if (WARM_START_K <= 0) return;
+            top.insert(std::find_if(top.begin(), top.end(), [&](const Operation_list& o) { return opl > o; }), opl);
+            if (top.size() > WARM_START_K) top.pop_back();
+        }
+        void save_warm(Search_block block, const GameInfo& game_info, const std::vector<Operation_list>& top) {
+            Warm_start& warm = warm_start[block];
+            warm.next_tower_id = game_info.next_tower_id;
+            warm.plans.clear();
+            for (const Operation_list& o : top) warm.plans.push_back(o.ops);
+        }
+
+        // 伤害场预筛：返回每个候选是否值得完整模拟
+        std::vector<bool> prefilter(const GameInfo& game_info, const std::vector<Defense_operation>& cands) {
+            if (PREFILTER_KEEP_RATIO >= 1) return std::vector<bool>(cands.size(), true);
+            return Damage_field(game_info, ctx.pid).prefilter(cands, PREFILTER_KEEP_RATIO);
+        }
+        // 统计预筛的召回率：完整模拟选出的最优候选是否在预筛保留的候选之中
+        void record_prefilter(const std::vector<bool>& kept, int best_idx) {
+            if (!PREFILTER_MEASURE || best_idx < 0) return;
+            prefilter_checks++;
+            prefilter_hits += kept[best_idx];
+            logger.err("prefilter recall: %d/%d", prefilter_hits, prefilter_checks);
+        }
+
         int min_avail_money_under_EMP(const GameInfo& game_info, const Defense_operation& my_op) {
-            Simulator op_done{game_info, pid, !pid};
-            op_done.task_list[pid] = my_op.ops;
+            Simulator op_done{ctx, game_info, ctx.pid, !ctx.pid};
+            op_done.task_list[ctx.pid] = my_op.ops;
             op_done.simulate(my_op.round_needed+1, -1);
 
-            int ans = 1e7;
-            int full = Util::calc_total_value(op_done.info, pid);
-            for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
-                Pos p{x, y};
-                if (MAP_PROPERTY[x][y] == -1) continue;
-                int residual = full - Util::EMP_banned_money(op_done.info, p, pid);
+            // 不在我方塔EMP范围内的点屏蔽不到钱，剩余即为full
+            int full = Util::calc_total_value(op_done.info, ctx.pid);
+            int ans = full;
+            Cell_set reach;
+            for (const Tower& t : op_done.info.towers) if (t.player == ctx.pid) reach |= super_weapon_area(t.x, t.y, EMP_RANGE);
+            for (int c : reach & VALID_CELLS) {
+                int residual = full - Util::EMP_banned_money(op_done.info, {cell_x(c), cell_y(c)}, ctx.pid);
                 ans = std::min(ans, residual);
             }
             return ans;
@@ -830,10 +1067,10 @@ class AI_ {
         void append_task_list(const GameInfo& game_info, const std::vector<Task>& task_list) {
             for (const Task& task : task_list) {
                 if (task.round == 0) {
-                    if (!game_info.is_operation_valid(pid, task.op)) logger.err("[w] Discard invalid operation %s", task.op.str(true).c_str());
+                    if (!game_info.is_operation_valid(ctx.pid, task.op)) logger.err("[w] Discard invalid operation %s", task.op.str(true).c_str());
                     else {
                         ops.push_back(task.op);
-                        avail_money += game_info.get_operation_income(pid, task.op);
+                        avail_money += game_info.get_operation_income(ctx.pid, task.op);
                     }
                 } else {
                     Task temp = task;
@@ -876,10 +1113,13 @@ class AI_ {
 
 
 
+// 被其它工具（如tools/selfplay.cpp）直接包含时，定义AI_NO_MAIN以去掉入口
+#ifndef AI_NO_MAIN
 int main() {
     AI_ ai = AI_();
 
     ai.run_ai();
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "simulate.hpp"
+
+/**
+ * 单边防守模拟的“无操作基准轨迹”
+ *
+ * 单边模拟中进攻方不操作，其蚂蚁只受信息素及防守方的塔影响。防守方的候选操作只改变塔与金钱，
+ * 在被改动的塔第一次能打到蚂蚁之前，蚂蚁、信息素、基地血量等与不操作时完全一致。
+ * 因此每次决策只完整模拟一次不操作的情形，并记录每回合开始时的Simulator作为检查点；
+ * 评估候选时先求出其“分歧回合”，从该回合的检查点分叉，再补上候选的塔与金钱继续模拟。
+ *
+ * 分歧回合取以下各项的最小值：
+ *  - 非塔操作（超级武器、基地升级）的预定时间；
+ *  - 对每个被新建/升级/降级/拆除的塔，自其第一个操作的预定时间起，基准轨迹中第一次有进攻方存活蚂蚁
+ *    落在该位置的覆盖集合内的回合（射程取该塔在两条轨迹中出现过的最大射程）；
+ *  - 基准轨迹在给定stopping_f_succ下提前停止的回合。
+ * 分歧之前被改动的塔都没有目标，只会冷却，其状态由一个不含蚂蚁的影子模拟给出。
+ */
+class Defence_baseline {
+    public:
+    const int atk_side;
+
+    /**
+     * @brief 模拟并记录基准轨迹
+     * @param ctx 决策上下文，基准轨迹自ctx.info开始，防守方为ctx.pid
+     * @param round 记录的回合数
+     */
+    Defence_baseline(Game_context& ctx, int round) : atk_side(!ctx.pid), ctx(ctx), rounds(round) {
+        Simulator sim(ctx, *ctx.info, ctx.pid, atk_side);
+        sim.start_simulation();
+        checkpoints.reserve(round + 1);
+        for (int r = 0; r <= round; r++) {
+            if (ctx.cancelled()) { // 被取消时只保留已记录的部分，covers随之缩短
+                rounds = r - 1;
+                break;
+            }
+            checkpoints.push_back(sim);
+            Cell_set occ;
+            for (const Ant& a : sim.info.ants) if (a.player == atk_side && a.is_alive()) occ.set(cell_index(a.x, a.y));
+            occupied.push_back(occ);
+            if (r < round) sim.continue_simulation(r + 1, -1);
+        }
+    }
+
+    // 基准轨迹能否用于给定的模拟
+    bool covers(int side, int round) const {
+        return side == atk_side && round <= rounds;
+    }
+
+    /**
+     * @brief 评估防守方的动作序列，结果与完整的单边模拟一致
+     * @param ops 防守方的动作序列（相对时间）
+     * @param round 模拟的回合数，不超过记录的回合数
+     * @param stopping_f_succ 同Simulator::simulate
+     * @return Sim_result 模拟结果
+     */
+    Sim_result evaluate(const std::vector<Task>& ops, int round, int stopping_f_succ) const {
+        const GameInfo& info = *ctx.info;
+        const int pid = ctx.pid;
+
+        // 1) 分歧回合
+        int fork = round;
+        for (const Task& t : ops) {
+            int type = t.op.type;
+            if (type != BuildTower && type != UpgradeTower && type != DowngradeTower) fork = std::min(fork, t.round);
+        }
+        // 被改动的塔：新建的塔以位置标识，其余以编号标识
+        struct Changed { int x, y, range, since; };
+        std::vector<Changed> changed;
+        int new_range = TOWER_INFO[TowerType::Basic].range;
+        for (const Task& t : ops) if (t.op.type == UpgradeTower && !info.tower_of_id(t.op.arg0)) new_range = std::max(new_range, TOWER_INFO[t.op.arg1].range);
+        for (const Task& t : ops) {
+            const Operation& op = t.op;
+            if (op.type == BuildTower) {
+                changed.push_back({op.arg0, op.arg1, new_range, t.round});
+            } else if (op.type == UpgradeTower || op.type == DowngradeTower) {
+                auto tower = info.tower_of_id(op.arg0);
+                if (!tower) continue; // 新建的塔，已按位置计入
+                int range = tower->range;
+                if (op.type == UpgradeTower) range = std::max(range, TOWER_INFO[op.arg1].range);
+                else for (int type = tower->type; type; type /= 10) range = std::max(range, TOWER_INFO[type / 10].range); // 降级后射程可能变大（如Pulse降为Mortar）
+                changed.push_back({tower->x, tower->y, range, t.round});
+            }
+        }
+        for (const Changed& c : changed) {
+            const Cell_set& cover = path_coverage(c.x, c.y, c.range);
+            for (int r = std::max(c.since, 0); r < fork; r++)
+                if ((cover & occupied[r]).any()) {
+                    fork = r;
+                    break;
+                }
+        }
+        const Sim_result& base_res = checkpoints[rounds].progress.res;
+        if (base_res.first_succ < stopping_f_succ) fork = std::min(fork, base_res.first_succ + 1);
+
+        // 2) 影子模拟：不含蚂蚁，只推演分歧前候选一方的塔、金钱及剩余任务
+        Simulator shadow(info, pid, atk_side);
+        shadow.task_list[pid] = ops;
+        shadow.start_simulation();
+        int offset = 0; // 候选相对基准轨迹的金钱差
+        for (int r = 0; r < fork; r++) {
+            shadow.info.ants.clear(); // 包括上一回合新生成的蚂蚁
+            int before = checkpoints[r].info.coins[pid] + offset;
+            shadow.info.coins[pid] = before;
+            int shadow_round = shadow.info.round;
+            shadow.continue_simulation(r + 1, -1);
+            offset += shadow.info.coins[pid] - before - (shadow.info.round != shadow_round ? BASIC_INCOME : 0);
+        }
+
+        // 3) 分歧时候选一方的塔：未被操作过的塔在基准轨迹中正常攻击，以基准轨迹为准；
+        // 被操作过的塔以影子模拟为准。被操作过但类型与基准轨迹相同（操作无效或先升后降）时无法确定其冷却，退回完整模拟
+        Fixed_vector<Tower, MAX_TOWER_NUM> towers;
+        const GameInfo& fork_info = checkpoints[fork].info;
+        for (const Tower& t : shadow.info.towers) {
+            auto base = std::find_if(fork_info.towers.begin(), fork_info.towers.end(), [&](const Tower& b) { return b.id == t.id; });
+            bool touched = std::any_of(ops.begin(), ops.end(), [&](const Task& task) {
+                return (task.op.type == UpgradeTower || task.op.type == DowngradeTower) && task.op.arg0 == t.id && task.round < fork;
+            });
+            if (base == fork_info.towers.end() || base->type != t.type) towers.push_back(t);
+            else if (!touched) towers.push_back(*base);
+            else return full_simulation(ops, round, stopping_f_succ);
+        }
+
+        // 4) 从分歧回合的检查点分叉
+        Simulator sim(checkpoints[fork]);
+        sim.ctx = &ctx;
+        ctx.sim_count++;
+        sim.info.coins[pid] += offset;
+        sim.info.next_tower_id = shadow.info.next_tower_id;
+        sim.info.towers = towers;
+        sim.task_list[pid] = shadow.task_list[pid];
+        sim.continue_simulation(round, stopping_f_succ);
+        return sim.simulation_result();
+    }
+
+    private:
+    Sim_result full_simulation(const std::vector<Task>& ops, int round, int stopping_f_succ) const {
+        Simulator sim(ctx, *ctx.info, ctx.pid, atk_side);
+        sim.task_list[ctx.pid] = ops;
+        return sim.simulate(round, stopping_f_succ);
+    }
+
+    Game_context& ctx;
+    int rounds;
+    std::vector<Simulator> checkpoints; // checkpoints[r]为第r回合开始时的Simulator
+    std::vector<Cell_set> occupied; // occupied[r]为第r回合进攻方存活蚂蚁所在的格子
+};
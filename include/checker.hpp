@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "game_info.hpp"
+
+/* 局面比对：先以结构化哈希快速判定，仅在哈希不一致时生成逐字段的差异报告 */
+
+namespace checker_detail {
+    inline uint64_t mix(uint64_t h, uint64_t v) {
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= h >> 31;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        return h ^ (h >> 29);
+    }
+    inline uint64_t pack(int a, int b) {
+        return uint64_t(uint32_t(a)) << 32 | uint32_t(b);
+    }
+}
+
+/**
+ * @brief 计算局面中蚂蚁、塔、金钱及超级武器冷却的结构化哈希
+ * @note 不包含基地血量（Simulator使用的并非真实血量）及信息素
+ * @param info 给定的局面
+ * @return uint64_t 哈希值
+ */
+inline uint64_t state_hash(const GameInfo& info) {
+    using checker_detail::mix;
+    using checker_detail::pack;
+    uint64_t h = mix(info.ants.size(), info.towers.size());
+    for (const Ant& a : info.ants) {
+        h = mix(h, pack(a.id, a.player));
+        h = mix(h, pack(a.x, a.y));
+        h = mix(h, pack(a.hp, a.level));
+        h = mix(h, pack(a.age, a.state));
+        h = mix(h, a.evasion);
+    }
+    for (const Tower& t : info.towers) {
+        h = mix(h, pack(t.id, t.player));
+        h = mix(h, pack(t.x, t.y));
+        h = mix(h, pack(t.type, t.cd));
+    }
+    h = mix(h, pack(info.coins[0], info.coins[1]));
+    for (int i = 0; i < 2; i++) for (int j = 0; j < SuperWeaponCount; j++) h = mix(h, info.super_weapon_cd[i][j]);
+    return h;
+}
+
+/**
+ * @brief 逐字段比对两个局面中参与state_hash的部分
+ * @param pred 预测的局面
+ * @param real 实际的局面
+ * @return std::string 差异报告，每条差异占一行，无差异时为空
+ */
+inline std::string state_diff(const GameInfo& pred, const GameInfo& real) {
+    std::string ans;
+    auto field = [&](std::string& line, const char* name, int p, int r) {
+        if (p != r) line += str_wrap(" %s %d->%d", name, p, r);
+    };
+
+    for (const Ant& r : real.ants) {
+        int idx = pred.ant_of_id_by_index(r.id);
+        if (idx < 0) {
+            ans += "ant unexpected: " + r.str(true) + '\n';
+            continue;
+        }
+        const Ant& p = pred.ants[idx];
+        std::string line;
+        field(line, "player", p.player, r.player);
+        field(line, "x", p.x, r.x);
+        field(line, "y", p.y, r.y);
+        field(line, "hp", p.hp, r.hp);
+        field(line, "level", p.level, r.level);
+        field(line, "age", p.age, r.age);
+        field(line, "state", p.state, r.state);
+        field(line, "evasion", p.evasion, r.evasion);
+        if (line.size()) ans += str_wrap("ant %d:", r.id) + line + '\n';
+    }
+    for (const Ant& p : pred.ants)
+        if (real.ant_of_id_by_index(p.id) < 0) ans += "ant missing: " + p.str(true) + '\n';
+
+    for (const Tower& r : real.towers) {
+        auto it = std::find_if(pred.towers.begin(), pred.towers.end(), [&](const Tower& t) { return t.id == r.id; });
+        if (it == pred.towers.end()) {
+            ans += "tower unexpected: " + r.str(true) + '\n';
+            continue;
+        }
+        std::string line;
+        field(line, "player", it->player, r.player);
+        field(line, "x", it->x, r.x);
+        field(line, "y", it->y, r.y);
+        field(line, "type", it->type, r.type);
+        field(line, "cd", it->cd, r.cd);
+        if (line.size()) ans += str_wrap("tower %d:", r.id) + line + '\n';
+    }
+    for (const Tower& p : pred.towers)
+        if (std::none_of(real.towers.begin(), real.towers.end(), [&](const Tower& t) { return t.id == p.id; })) ans += "tower missing: " + p.str(true) + '\n';
+
+    // 数量相同但顺序不同同样会影响模拟
+    bool same_order = pred.ants.size() == real.ants.size();
+    for (size_t i = 0; same_order && i < real.ants.size(); i++) same_order = pred.ants[i].id == real.ants[i].id;
+    if (!same_order && ans.empty()) ans += "ant order differs\n";
+
+    std::string line;
+    for (int i = 0; i < 2; i++) field(line, i ? "coin1" : "coin0", pred.coins[i], real.coins[i]);
+    for (int i = 0; i < 2; i++) for (int j = 1; j < SuperWeaponCount; j++)
+        if (pred.super_weapon_cd[i][j] != real.super_weapon_cd[i][j])
+            line += str_wrap(" cd[%d][%d] %d->%d", i, j, pred.super_weapon_cd[i][j], real.super_weapon_cd[i][j]);
+    if (line.size()) ans += "global:" + line + '\n';
+    return ans;
+}
@@ -16,8 +16,11 @@
 #include <cmath>
 #include <optional>
 #include <cassert>
+#include <array>
+#include <cstdint>
 
 #include "logger.hpp"
+#include "fixed_vector.hpp"
 
 /**
  * @brief Max number of rounds.
@@ -116,9 +119,13 @@ inline int distance_raw(int x0, int y0, int x1, int y1)
 
     return dx + dy;
 }
+void init_coverage_array();
+void init_area_array();
 void init_dist_array() {
     for (int x0 = 0; x0 < MAP_SIZE; x0++) for (int x1 = 0; x1 < MAP_SIZE; x1++)
         for (int y0 = 0; y0 < MAP_SIZE; y0++) for (int y1 = 0; y1 < MAP_SIZE; y1++) dist_array[x0][y0][x1][y1] = distance_raw(x0, y0, x1, y1);
+    init_coverage_array(); // 依赖距离表
+    init_area_array();
 }
 
 inline int distance(int x0, int y0, int x1, int y1)
@@ -272,13 +279,18 @@ struct Ant
     int x, y;
     int hp, level, age;
     AntState state;
-    std::vector<int> path;
     int evasion; // tag for emergency evasion
     bool deflector;  // tag for deflector
     // Static info
     static constexpr int AGE_LIMIT = 32;
     static constexpr int MAX_HP_INFO[] = {10, 25, 50}; // Max HP of an ant of certain level
     static constexpr int REWARD_INFO[] = {3, 5, 7};    // Reward for killing an ant of certain level
+    /**
+     * @brief Max length of the path.
+     * @note An ant moves at most once per round and dies after AGE_LIMIT rounds.
+     */
+    static constexpr int MAX_PATH_LENGTH = AGE_LIMIT + 2;
+    Fixed_vector<signed char, MAX_PATH_LENGTH> path; ///< Directions moved so far
 
     /**
      * @brief Construct a new ant with given information.
@@ -357,6 +369,16 @@ struct Ant
     }
 };
 
+/**
+ * @brief Max number of ants on the map.
+ * @note Each base generates at most one ant per round, and an ant lives no longer than AGE_LIMIT rounds.
+ */
+static constexpr int MAX_ANT_NUM = 2 * (Ant::AGE_LIMIT + 4);
+/**
+ * @brief Container of all ants on the map.
+ */
+using Ant_list = Fixed_vector<Ant, MAX_ANT_NUM>;
+
 /**
  * @brief Tag for the type of a tower. The integer values of these enumeration items
  * are also their indexes.
@@ -442,6 +464,326 @@ constexpr TowerInfo TOWER_INFO[] = {
     {30, 3, 2}, // ID = 32 
     {45, 6, 5}  // ID = 33
 };
+/**
+ * @brief Max attacking range among all types of tower.
+ */
+static constexpr int MAX_TOWER_RANGE = [] {
+    int ans = 0;
+    for (const TowerInfo& info : TOWER_INFO) ans = std::max(ans, info.range);
+    return ans;
+}();
+
+/**
+ * @brief Index of a point on the map in a Bitboard, in row-major order.
+ */
+constexpr int cell_index(int x, int y)
+{
+    return x * MAP_SIZE + y;
+}
+/**
+ * @brief The x-coordinate of the point with given index.
+ * @see cell_index
+ */
+constexpr int cell_x(int index)
+{
+    return index / MAP_SIZE;
+}
+/**
+ * @brief The y-coordinate of the point with given index.
+ * @see cell_index
+ */
+constexpr int cell_y(int index)
+{
+    return index % MAP_SIZE;
+}
+
+/**
+ * @brief A set of points on the map as a bitboard of MAP_SIZE * MAP_SIZE bits, with bit cell_index(x, y) for point (x, y).
+ * Bits past the last point are always zero.
+ * @note Iterating over a bitboard yields indexes of the points in it in ascending order, i.e. the same order as
+ * "for x for y" loops over the map.
+ */
+class Bitboard
+{
+public:
+    static constexpr int SIZE = MAP_SIZE * MAP_SIZE;
+    static constexpr int WORDS = (SIZE + 63) / 64;
+
+    constexpr Bitboard() : word{} {}
+
+    constexpr bool test(int index) const
+    {
+        return word[index >> 6] >> (index & 63) & 1;
+    }
+    constexpr Bitboard& set(int index)
+    {
+        word[index >> 6] |= uint64_t(1) << (index & 63);
+        return *this;
+    }
+    constexpr Bitboard& reset(int index)
+    {
+        word[index >> 6] &= ~(uint64_t(1) << (index & 63));
+        return *this;
+    }
+    constexpr Bitboard& reset()
+    {
+        for (uint64_t& w : word) w = 0;
+        return *this;
+    }
+
+    constexpr bool any() const
+    {
+        uint64_t ans = 0;
+        for (uint64_t w : word) ans |= w;
+        return ans;
+    }
+    constexpr bool none() const
+    {
+        return !any();
+    }
+    int count() const
+    {
+        int ans = 0;
+        for (uint64_t w : word) ans += __builtin_popcountll(w);
+        return ans;
+    }
+
+    constexpr Bitboard& operator&=(const Bitboard& other)
+    {
+        for (int i = 0; i < WORDS; i++) word[i] &= other.word[i];
+        return *this;
+    }
+    constexpr Bitboard& operator|=(const Bitboard& other)
+    {
+        for (int i = 0; i < WORDS; i++) word[i] |= other.word[i];
+        return *this;
+    }
+    constexpr Bitboard& operator^=(const Bitboard& other)
+    {
+        for (int i = 0; i < WORDS; i++) word[i] ^= other.word[i];
+        return *this;
+    }
+    constexpr Bitboard operator&(const Bitboard& other) const { return Bitboard(*this) &= other; }
+    constexpr Bitboard operator|(const Bitboard& other) const { return Bitboard(*this) |= other; }
+    constexpr Bitboard operator^(const Bitboard& other) const { return Bitboard(*this) ^= other; }
+    constexpr Bitboard operator~() const
+    {
+        Bitboard ans;
+        for (int i = 0; i < WORDS; i++) ans.word[i] = ~word[i];
+        ans.word[WORDS - 1] &= ~uint64_t(0) >> (WORDS * 64 - SIZE);
+        return ans;
+    }
+    constexpr bool operator==(const Bitboard& other) const
+    {
+        for (int i = 0; i < WORDS; i++) if (word[i] != other.word[i]) return false;
+        return true;
+    }
+    constexpr bool operator!=(const Bitboard& other) const { return !(*this == other); }
+
+    /**
+     * @brief Move every point by "delta" in index, dropping those moved out of range.
+     * @note Points may wrap around to adjacent rows. See neighbours_in for moving along the map.
+     */
+    constexpr Bitboard shifted(int delta) const
+    {
+        Bitboard ans;
+        int words = (delta < 0 ? -delta : delta) >> 6, bits = (delta < 0 ? -delta : delta) & 63;
+        for (int i = 0; i < WORDS; i++) {
+            int from = delta < 0 ? i + words : i - words;
+            uint64_t w = 0;
+            if (from >= 0 && from < WORDS) w = delta < 0 ? word[from] >> bits : word[from] << bits;
+            int carry = delta < 0 ? from + 1 : from - 1;
+            if (bits && carry >= 0 && carry < WORDS) w |= delta < 0 ? word[carry] << (64 - bits) : word[carry] >> (64 - bits);
+            ans.word[i] = w;
+        }
+        ans.word[WORDS - 1] &= ~uint64_t(0) >> (WORDS * 64 - SIZE);
+        return ans;
+    }
+
+    /**
+     * @brief Get the points adjacent to some point of the set in a direction.
+     * @param direction Index of the direction, as in OFFSET.
+     * @return The set of points.
+     */
+    constexpr Bitboard neighbours_in(int direction) const;
+
+    /**
+     * @brief Get the points adjacent to some point of the set.
+     * @return The set of points, including those of the set itself only if they are adjacent to another.
+     */
+    constexpr Bitboard neighbours() const
+    {
+        Bitboard ans;
+        for (int i = 0; i < 6; i++) ans |= neighbours_in(i);
+        return ans;
+    }
+
+    // Iterator over indexes of points in the set
+    class iterator
+    {
+    public:
+        constexpr iterator(const uint64_t* word, int i) : word(word), i(i), rest(i < WORDS ? word[i] : 0) { skip(); }
+        constexpr int operator*() const { return i * 64 + __builtin_ctzll(rest); }
+        constexpr iterator& operator++()
+        {
+            rest &= rest - 1;
+            skip();
+            return *this;
+        }
+        constexpr bool operator!=(const iterator& other) const { return i != other.i || rest != other.rest; }
+
+    private:
+        const uint64_t* word;
+        int i;
+        uint64_t rest;
+
+        constexpr void skip()
+        {
+            while (!rest && i < WORDS) if (++i < WORDS) rest = word[i];
+        }
+    };
+    constexpr iterator begin() const { return iterator(word, 0); }
+    constexpr iterator end() const { return iterator(word, WORDS); }
+
+private:
+    uint64_t word[WORDS];
+};
+
+/**
+ * @brief Get the set of points satisfying a predicate on their coordinates.
+ * @param pred Callable as pred(x, y).
+ */
+template<typename Pred>
+constexpr Bitboard bitboard_of(Pred pred)
+{
+    Bitboard ans;
+    for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++)
+        if (pred(x, y)) ans.set(cell_index(x, y));
+    return ans;
+}
+
+/**
+ * @brief All valid points on the map.
+ * @see is_valid_pos
+ */
+static constexpr Bitboard VALID_CELLS = bitboard_of([](int x, int y) { return MAP_PROPERTY[x][y] != PointType::Void; });
+/**
+ * @brief All points reachable for ants.
+ * @see is_path
+ */
+static constexpr Bitboard PATH_CELLS = bitboard_of([](int x, int y) { return MAP_PROPERTY[x][y] == PointType::Path; });
+/**
+ * @brief Points where each player can build towers: "HIGHLAND_CELLS[player_id]".
+ * @see is_highland
+ */
+static constexpr Bitboard HIGHLAND_CELLS[2] = {
+    bitboard_of([](int x, int y) { return MAP_PROPERTY[x][y] == PointType::Player0Highland; }),
+    bitboard_of([](int x, int y) { return MAP_PROPERTY[x][y] == PointType::Player1Highland; })
+};
+/**
+ * @brief Points whose neighbour in a direction stays inside the MAP_SIZE * MAP_SIZE grid,
+ * split by the parity of y: "NEIGHBOUR_SOURCE[y % 2][direction]".
+ */
+static constexpr auto NEIGHBOUR_SOURCE = [] {
+    std::array<std::array<Bitboard, 6>, 2> ans{};
+    for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) for (int i = 0; i < 6; i++) {
+        int nx = x + OFFSET[y % 2][i][0], ny = y + OFFSET[y % 2][i][1];
+        if (nx >= 0 && nx < MAP_SIZE && ny >= 0 && ny < MAP_SIZE) ans[y % 2][i].set(cell_index(x, y));
+    }
+    return ans;
+}();
+
+constexpr Bitboard Bitboard::neighbours_in(int direction) const
+{
+    Bitboard ans;
+    for (int p = 0; p < 2; p++)
+        ans |= (*this & NEIGHBOUR_SOURCE[p][direction]).shifted(cell_index(OFFSET[p][direction][0], OFFSET[p][direction][1]));
+    return ans;
+}
+
+/**
+ * @brief A set of points on the map, indexed by cell_index().
+ */
+using Cell_set = Bitboard;
+
+// 塔的覆盖集合：coverage_array[x][y][r]为与(x, y)距离不超过r的全部路径点
+static Cell_set coverage_array[MAP_SIZE][MAP_SIZE][MAX_TOWER_RANGE + 1];
+static int coverage_size_array[MAP_SIZE][MAP_SIZE][MAX_TOWER_RANGE + 1];
+void init_coverage_array() {
+    for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
+        if (!is_valid_pos(x, y)) continue;
+        for (int c : PATH_CELLS)
+            for (int r = distance(x, y, cell_x(c), cell_y(c)); r <= MAX_TOWER_RANGE; r++) coverage_array[x][y][r].set(c);
+        for (int r = 0; r <= MAX_TOWER_RANGE; r++) coverage_size_array[x][y][r] = coverage_array[x][y][r].count();
+    }
+}
+
+/**
+ * @brief Get all path points within given range of a point, i.e. all points where an ant can be attacked
+ * by a tower at the given point.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param range Radius of the area, no more than MAX_TOWER_RANGE.
+ * @return The set of path points.
+ * @note Available after init_dist_array().
+ */
+inline const Cell_set& path_coverage(int x, int y, int range)
+{
+    return coverage_array[x][y][range];
+}
+
+/**
+ * @brief Get the number of path points within given range of a point.
+ * @see path_coverage
+ */
+inline int path_coverage_size(int x, int y, int range)
+{
+    return coverage_size_array[x][y][range];
+}
+
+/**
+ * @brief How a tower chooses the ants affected by one shot.
+ */
+enum SplashKind
+{
+    SingleTarget, ///< Only the target itself
+    AroundTarget, ///< Attackable ants within "splash_range" of the target
+    AroundTower   ///< Attackable ants within the tower's own range
+};
+/**
+ * @brief Structure of attacking behaviour of a type of towers.
+ */
+struct TowerAttackTrait
+{
+    int target_num;     ///< How many targets to find each time
+    SplashKind splash;
+    int splash_range;   ///< Radius of the splash, only for SplashKind::AroundTarget
+};
+/**
+ * @brief Attacking behaviour of all types of tower.
+ */
+constexpr TowerAttackTrait TOWER_ATTACK_TRAIT[] = {
+    {1, SingleTarget, 0}, // ID = 0
+    {1, SingleTarget, 0}, // ID = 1
+    {1, SingleTarget, 0}, // ID = 2
+    {1, AroundTarget, 1}, // ID = 3
+    {}, {}, {}, {}, {}, {}, {}, // Padding
+    {1, SingleTarget, 0}, // ID = 11
+    {1, SingleTarget, 0}, // ID = 12
+    {1, SingleTarget, 0}, // ID = 13
+    {}, {}, {}, {}, {}, {}, {}, // Padding
+    {1, SingleTarget, 0}, // ID = 21
+    {2, SingleTarget, 0}, // ID = 22
+    {1, SingleTarget, 0}, // ID = 23
+    {}, {}, {}, {}, {}, {}, {}, // Padding
+    {1, AroundTarget, 1}, // ID = 31
+    {1, AroundTower, 0},  // ID = 32
+    {1, AroundTarget, 2}  // ID = 33
+};
+/**
+ * @brief Max number of targets found by a tower each time.
+ */
+static constexpr int MAX_TARGET_NUM = 2;
 struct Tower
 {
     int id, player;
@@ -482,41 +824,87 @@ struct Tower
 
     /**
      * @brief Try to attack ants around, and update CD time.
-     * @param ants Reference to all ants on the map, holding in a vector.
-     * @return The indexes of attacked ants without repeat (i.e. an ant that is attacked multiple
-     * times only appears once when returned).
-     * @see Tower::find_targets for target searching process.
+     * @param ants Reference to all ants on the map, holding in an Ant_list.
+     * @return The indexes of attacked ants in ascending order without repeat (i.e. an ant that is attacked
+     * multiple times only appears once when returned).
+     * @note Equivalent to calling Tower::find_targets and Tower::find_attackable, then applying Tower::action
+     * to each affected ant in order, but works entirely on stack buffers. The behaviour of each tower type
+     * comes from TOWER_ATTACK_TRAIT.
      */
-    std::vector<int> attack(std::vector<Ant>& ants, bool verbose = false)
+    Fixed_vector<int, MAX_ANT_NUM> attack(Ant_list& ants, bool verbose = false)
     {
-        std::vector<int> attacked_idxs;
+        Fixed_vector<int, MAX_ANT_NUM> attacked_idxs;
         // Count down CD
         cd = std::max(cd - 1, 0);
         if (verbose) fprintf(stderr, "Tower %2d: cd%d", id, cd);
         if (cd <= 0) // Ready to attack
         {
+            const TowerAttackTrait& trait = TOWER_ATTACK_TRAIT[type];
             // How many times the tower will try to find targets in this turn
             int time = speed >= 1 ? 1 : (1 / speed);
-            // How many targets the tower should find each time (maybe less than required number)
-            int target_num = type == Double ? 2 : 1;
-            // Find and action
             if (verbose) fprintf(stderr, " time%d", time);
+            const int n = ants.size();
+            bool hit[MAX_ANT_NUM] = {};
+            bool any_hit = false;
             while (time--)
             {
-                std::vector<int> target_idxs = find_targets(ants, target_num);
-                std::vector<int> attackable_idxs = find_attackable(ants, target_idxs);
-                if (verbose && target_idxs.size()) fprintf(stderr, " targ%d", ants[target_idxs[0]].id);
-                if (verbose && attackable_idxs.size()) fprintf(stderr, " atk%d", ants[attackable_idxs[0]].id);
-                for (int idx: attackable_idxs)
-                    action(ants[idx]);
-                attacked_idxs.insert(attacked_idxs.end(), attackable_idxs.begin(), attackable_idxs.end());
+                // Attackable ants in range, as keys (distance << 8 | index) so that the order of keys is
+                // the order of Tower::find_targets
+                static_assert(MAX_ANT_NUM <= 0x100, "ant index must fit in the low 8 bits of a key");
+                int in_range[MAX_ANT_NUM], in_range_num = 0;
+                for (int i = 0; i < n; ++i)
+                    if (ants[i].is_attackable_from(player, x, y, range))
+                        in_range[in_range_num++] = distance(ants[i].x, ants[i].y, x, y) << 8 | i;
+                if (in_range_num == 0) continue;
+                // Select the first target_num keys
+                int targets[MAX_TARGET_NUM] = {}, target_num = std::min(trait.target_num, in_range_num);
+                for (int t = 0; t < target_num; ++t)
+                {
+                    int best = -1;
+                    for (int k = 0; k < in_range_num; ++k)
+                        if (in_range[k] >= 0 && (best < 0 || in_range[k] < in_range[best]))
+                            best = k;
+                    targets[t] = in_range[best] & 0xff;
+                    in_range[best] = -1 - in_range[best]; // 标记为已选，之后按原值恢复
+                }
+                // Affected ants of all targets are settled before any damage
+                int affected[MAX_TARGET_NUM * MAX_ANT_NUM], affected_num = 0;
+                for (int t = 0; t < target_num; ++t)
+                {
+                    const Ant& target = ants[targets[t]];
+                    switch (trait.splash)
+                    {
+                        case SingleTarget:
+                            affected[affected_num++] = targets[t];
+                            break;
+                        case AroundTarget:
+                            for (int i = 0; i < n; ++i)
+                                if (ants[i].is_attackable_from(player, target.x, target.y, trait.splash_range))
+                                    affected[affected_num++] = i;
+                            break;
+                        case AroundTower:
+                            for (int k = 0; k < in_range_num; ++k)
+                                affected[affected_num++] = (in_range[k] < 0 ? -1 - in_range[k] : in_range[k]) & 0xff;
+                            break;
+                    }
+                }
+                if (verbose) fprintf(stderr, " targ%d", ants[targets[0]].id);
+                if (verbose && affected_num) fprintf(stderr, " atk%d", ants[affected[0]].id);
+                for (int k = 0; k < affected_num; ++k)
+                {
+                    action(ants[affected[k]]);
+                    hit[affected[k]] = true;
+                }
+                any_hit |= affected_num > 0;
             }
-            // Uniquify to prevent multiple occurances of the same ant
-            std::sort(attacked_idxs.begin(), attacked_idxs.end());
-            attacked_idxs.erase(std::unique(attacked_idxs.begin(), attacked_idxs.end()), attacked_idxs.end());
-            // Reset CD if really attacks
-            if (!attacked_idxs.empty())
+            // Collect in ascending order, which also removes duplicates
+            if (any_hit)
+            {
+                for (int i = 0; i < n; ++i)
+                    if (hit[i]) attacked_idxs.push_back(i);
+                // Reset CD if really attacks
                 reset_cd();
+            }
         }
         if (verbose) fprintf(stderr, "\n");
         return attacked_idxs;
@@ -524,14 +912,14 @@ struct Tower
 
     /**
      * @brief Find certain amount of targets and return its reference by index in order.
-     * @param ants Reference to all ants on the map, holding in a vector.
+     * @param ants Reference to all ants on the map, holding in an Ant_list.
      * @param target_num How many targets to find.
      * @return The indexes of targets.
      * @note Terminology: "targets" refers to all the ants discovered by the tower when searching enemy,
      * which is only a SUBSET of all the ants affected by this tower. For example, towers with range attack
      * ability will find some targets and fire directly at them, which may cause damage to ants around the targets.
      */
-    std::vector<int> find_targets(const std::vector<Ant>& ants, int target_num) const
+    std::vector<int> find_targets(const Ant_list& ants, int target_num) const
     {
         // Initialize index array for reference
         std::vector<int> idxs = get_attackable_ants(ants, x, y, range);
@@ -553,13 +941,13 @@ struct Tower
 
     /**
      * @brief Find all ants affected by this attack based on given targets.
-     * @param ants Reference to all ants on the map, holding in a vector.
+     * @param ants Reference to all ants on the map, holding in an Ant_list.
      * @param target_idxs Indexes of all targets.
      * @return Indexes of all ants involved, with possible duplication (i.e. an ant that is attacked multiple times
      * appears a corresponding number of times when returned).
      * @see Tower::find_targets for more information on the term "targets".
      */
-    std::vector<int> find_attackable(const std::vector<Ant>& ants, const std::vector<int>& target_idxs) const
+    std::vector<int> find_attackable(const Ant_list& ants, const std::vector<int>& target_idxs) const
     {
         std::vector<int> attackable_idxs;
         for (int idx: target_idxs)
@@ -609,13 +997,13 @@ struct Tower
 
     /**
      * @brief Find all attackable ants based on given position and range.
-     * @param ants Reference to all ants on the map, holding in a vector.
+     * @param ants Reference to all ants on the map, holding in an Ant_list.
      * @param x The x-coordinate of the position.
      * @param y The y-coordinate of the position.
      * @param range Radius of the area to search.
      * @return Indexes of all ants involved without repeat.
      */
-    std::vector<int> get_attackable_ants(const std::vector<Ant>& ants, int x, int y, int range) const
+    std::vector<int> get_attackable_ants(const Ant_list& ants, int x, int y, int range) const
     {
         std::vector<int> idxs;
         for (int i = 0; i < ants.size(); ++i)
@@ -624,6 +1012,23 @@ struct Tower
         return idxs;
     }
 
+    /**
+     * @brief Get all path points within the range of the tower.
+     * @see path_coverage
+     */
+    const Cell_set& coverage() const
+    {
+        return path_coverage(x, y, range);
+    }
+
+    /**
+     * @brief Update CD time only, which is equivalent to Tower::attack when no ant is attackable.
+     */
+    void idle()
+    {
+        cd = std::max(cd - 1, 0);
+    }
+
     /**
      * @brief Check if the tower is ready to attack.
      * @return Whether the tower is ready.
@@ -705,7 +1110,7 @@ struct Tower
 struct Base
 {
     // Attributes
-    const int player, x, y;
+    int player, x, y;
     int hp;
     int gen_speed_level; ///< Level of production speed
     int ant_level;       ///< Level of produced ants
@@ -802,8 +1207,49 @@ struct SuperWeapon
     {
         return distance(x, y, this->x, this->y) <= range;
     }
+
+    /**
+     * @brief Get all points in the range of effect.
+     * @see super_weapon_area
+     */
+    const Cell_set& area() const;
 };
 
+/**
+ * @brief Max range of effect among all types of super weapons.
+ */
+static constexpr int MAX_SUPER_WEAPON_RANGE = [] {
+    int ans = 0;
+    for (const auto& info : SUPER_WEAPON_INFO) ans = std::max(ans, info[1]);
+    return ans;
+}();
+
+// 超级武器的作用区域：area_array[x][y][r]为与(x, y)距离不超过r的全部格子（与覆盖集合不同，不限于路径点）
+static Cell_set area_array[MAP_SIZE][MAP_SIZE][MAX_SUPER_WEAPON_RANGE + 1];
+void init_area_array() {
+    for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++)
+        for (int px = 0; px < MAP_SIZE; px++) for (int py = 0; py < MAP_SIZE; py++)
+            for (int r = distance(x, y, px, py); r <= MAX_SUPER_WEAPON_RANGE; r++) area_array[x][y][r].set(cell_index(px, py));
+}
+
+/**
+ * @brief Get all points within given range of a point, i.e. the area affected by a super weapon used there.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param range Radius of the area, no more than MAX_SUPER_WEAPON_RANGE.
+ * @return The set of points.
+ * @note Available after init_dist_array().
+ */
+inline const Cell_set& super_weapon_area(int x, int y, int range)
+{
+    return area_array[x][y][range];
+}
+
+inline const Cell_set& SuperWeapon::area() const
+{
+    return super_weapon_area(x, y, range);
+}
+
 /* Operation */
 
 /**
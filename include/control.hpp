@@ -13,6 +13,7 @@
 #include <vector>
 #include "game_info.hpp"
 #include "io.hpp"
+#include "trace.hpp"
 
 /**
  * @brief An integrated module of IO and game state management with simple interfaces
@@ -36,7 +37,7 @@ private:
      */
     void update_towers(std::vector<Tower>& new_towers)
     {
-        info.towers = std::move(new_towers);
+        info.towers.assign(new_towers.begin(), new_towers.end());
         info.next_tower_id = std::max(info.next_tower_id, info.towers.empty() ? 0 : info.towers.back().id + 1);
     }
 
@@ -99,15 +100,16 @@ private:
         info.set_base_hp(1, hp1);
     }
 
+public:
+    const int self_player_id; ///< Your player ID
+    Trace_writer* trace = nullptr; ///< (Optional) Recorder of received states and exchanged operations
+
     /**
      * @brief Construct a new Controller object with given init info.
      */
-    Controller(InitInfo init_info)
+    explicit Controller(InitInfo init_info)
         : info(init_info.second), self_player_id(init_info.first) {}
 
-public:
-    const int self_player_id; ///< Your player ID
-
     /**
      * @brief Construct a new Controller object. Read initializing information from
      *        judger and initialize.
@@ -150,6 +152,18 @@ public:
         // fprintf(stderr, "Read round::Read\n");
         auto result = ::read_round_info();
         // 2. Update
+        update_round_info(result);
+        // 3. Record
+        if (trace) trace->record_state(info);
+    }
+
+    /**
+     * @brief Update current game state with round information that has already been read
+     *        (e.g. from judger or from a replay file).
+     * @param result The deserialized round information.
+     */
+    void update_round_info(RoundInfo& result)
+    {
         // 1) Towers
         // fprintf(stderr, "Read round::Towers\n");
         update_towers(result.towers);
@@ -176,7 +190,17 @@ public:
      */
     void read_opponent_operations()
     {
-        opponent_operations = ::read_opponent_operations();
+        update_opponent_operations(::read_opponent_operations());
+        if (trace) trace->record_opponent_operations(opponent_operations);
+    }
+
+    /**
+     * @brief Overwrite "opponent_operations" with operations that have already been read.
+     * @param ops Opponent's operations.
+     */
+    void update_opponent_operations(std::vector<Operation> ops)
+    {
+        opponent_operations = std::move(ops);
     }
 
     /**
@@ -238,5 +262,6 @@ public:
     void send_self_operations() const
     {
         send_operations(self_operations);        
+        if (trace) trace->record_self_operations(self_operations);
     }
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "game_info.hpp"
+#include "operation.hpp"
+
+// 对防守方动作序列的解析式估计
+struct Leak_estimate {
+    int first_leak = MAX_ROUND + 1; // 估计第一只蚂蚁抵达我方基地的回合数（相对时间），不会漏过时为MAX_ROUND+1
+    double margin = 0; // 所有轨迹上“累计伤害-蚂蚁血量”的最小值，越大越安全
+
+    bool operator>(const Leak_estimate& other) const {
+        if (first_leak != other.first_leak) return first_leak > other.first_leak;
+        return margin > other.margin;
+    }
+};
+
+/**
+ * 伤害场：不做完整模拟，仅由塔的布局及TOWER_INFO估计防守效果，用于在完整模拟前粗筛候选
+ *
+ * 构造时按当前信息素为进攻方的每只存活蚂蚁（以及下一只新生成的蚂蚁）推演一条走廊，
+ * 假定信息素在此期间不变、蚂蚁每回合前进一格；之后每个候选只需把塔的每回合期望伤害沿走廊累加，
+ * 累计伤害不足蚂蚁血量的走廊即视为会漏过，漏过时间为走廊长度（加上出生等待）。
+ * 不考虑溅射、冰冻、闪避及偏转，候选中含超级武器时无法估计，总是保留。
+ */
+class Damage_field {
+    public:
+    /**
+     * @brief 构造伤害场
+     * @param info 当前局面
+     * @param pid 防守方的玩家编号
+     */
+    Damage_field(const GameInfo& info, int pid) : info(info), pid(pid) {
+        Move_table moves(info); // 各走廊在同一信息素下推演，汇合后的移动可以共用
+        for (const Ant& ant : info.ants)
+            if (ant.player != pid && ant.is_alive()) trace_corridor(moves, ant, 0);
+
+        // 进攻方下一只新生成的蚂蚁
+        const Base& base = info.bases[!pid];
+        int cycle = Base::GENERATION_CYCLE_INFO[base.gen_speed_level];
+        int delay = cycle - info.round % cycle;
+        Ant newborn(-1, !pid, base.x, base.y, Ant::MAX_HP_INFO[base.ant_level], base.ant_level, 0, AntState::Alive);
+        trace_corridor(moves, newborn, delay);
+    }
+
+    /**
+     * @brief 估计执行给定动作序列（视为立即完成）后的防守效果
+     * @param ops 动作序列
+     * @return std::optional<Leak_estimate> 估计结果，序列中含无法估计的动作时为nullopt
+     */
+    std::optional<Leak_estimate> estimate(const std::vector<Task>& ops) const {
+        Fixed_vector<Tower, MAX_TOWER_NUM> towers;
+        for (const Tower& t : info.towers) if (t.player == pid && !info.is_shielded_by_emp(t)) towers.push_back(t);
+        int next_id = info.next_tower_id;
+        for (const Task& task : ops) {
+            const Operation& op = task.op;
+            auto it = std::find_if(towers.begin(), towers.end(), [&](const Tower& t) { return t.id == op.arg0; });
+            switch (op.type) {
+                case BuildTower:
+                    towers.emplace_back(next_id++, pid, op.arg0, op.arg1);
+                    break;
+                case UpgradeTower:
+                    if (it != towers.end()) it->upgrade(static_cast<TowerType>(op.arg1));
+                    break;
+                case DowngradeTower:
+                    if (it == towers.end()) break;
+                    if (it->is_downgrade_valid()) it->downgrade();
+                    else towers.erase(it);
+                    break;
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        // 每个路径格上每回合的期望伤害
+        double dps[MAP_SIZE * MAP_SIZE] = {};
+        for (int cell : cells) {
+            if (dps[cell] != 0) continue;
+            double sum = 1e-9; // 区分“未计算”与“无伤害”
+            for (const Tower& t : towers)
+                if (t.coverage().test(cell)) sum += t.damage / t.speed;
+            dps[cell] = sum;
+        }
+
+        Leak_estimate ans;
+        ans.margin = 1e9;
+        for (const Corridor& c : corridors) {
+            double dmg = 0;
+            for (int k = c.begin; k < c.end; k++) dmg += dps[cells[k]];
+            ans.margin = std::min(ans.margin, dmg - c.hp);
+            if (c.reach && dmg < c.hp) ans.first_leak = std::min(ans.first_leak, c.delay + c.end - c.begin);
+        }
+        return ans;
+    }
+
+    /**
+     * @brief 按估计结果保留较优的一部分候选
+     * @param cands 候选动作序列
+     * @param keep_ratio 保留的比例，不少于1时全部保留
+     * @param min_keep 至少保留的候选数
+     * @return std::vector<bool> 每个候选是否保留（原顺序不变）；无法估计的候选总是保留
+     */
+    std::vector<bool> prefilter(const std::vector<Defense_operation>& cands, double keep_ratio, int min_keep = 8) const {
+        std::vector<bool> keep(cands.size(), true);
+        if (keep_ratio >= 1) return keep;
+
+        std::vector<std::optional<Leak_estimate>> est(cands.size());
+        std::vector<int> ranked;
+        for (int i = 0; i < cands.size(); i++) {
+            est[i] = estimate(cands[i].ops);
+            if (est[i]) ranked.push_back(i);
+        }
+        int keep_count = std::max<int>(min_keep, std::ceil(keep_ratio * ranked.size()));
+        if (keep_count >= ranked.size()) return keep;
+        std::stable_sort(ranked.begin(), ranked.end(), [&](int a, int b) { return *est[a] > *est[b]; });
+        for (int k = keep_count; k < ranked.size(); k++) keep[ranked[k]] = false;
+        return keep;
+    }
+
+    private:
+    // 一只蚂蚁的推演走廊，为cells[begin, end)
+    struct Corridor {
+        int begin, end;
+        int hp;
+        int delay; // 出生前的等待回合数
+        bool reach; // 是否能在寿命内抵达我方基地
+    };
+
+    const GameInfo& info;
+    int pid;
+    std::vector<int> cells; // 所有走廊依次拼接，元素为cell_index
+    std::vector<Corridor> corridors;
+
+    // 按当前信息素推演ant此后的轨迹
+    void trace_corridor(Move_table& moves, Ant ant, int delay) {
+        const int target_x = Base::POSITION[pid][0], target_y = Base::POSITION[pid][1];
+        Corridor c{(int)cells.size(), 0, ant.hp, delay, false};
+        // 与Simulator::next_round一致：每回合先在当前格挨打，再移动，移动后到达基地即漏过
+        while (++ant.age <= Ant::AGE_LIMIT) {
+            cells.push_back(cell_index(ant.x, ant.y));
+            ant.move(moves.next_move(ant));
+            if (ant.x == target_x && ant.y == target_y) {
+                c.reach = true;
+                break;
+            }
+        }
+        c.end = cells.size();
+        corridors.push_back(c);
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class Undo_log;
+
+/**
+ * 容量固定、元素内联存储的vector
+ *
+ * 元素及计数均位于对象内部，因此只要T可平凡复制，整个容器即可平凡复制（复制即一次memcpy），
+ * 不涉及任何堆分配。接口与std::vector的常用子集一致，迭代器为裸指针，范围for及<algorithm>均可直接使用。
+ * 超出容量视为逻辑错误，由assert检查。
+ */
+template<typename T, int N>
+class Fixed_vector {
+    static_assert(std::is_trivially_copyable_v<T>, "Fixed_vector requires a trivially copyable element type");
+
+    public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    Fixed_vector() = default;
+    Fixed_vector(const std::vector<T>& v) { assign(v.begin(), v.end()); }
+
+    Fixed_vector& operator=(const std::vector<T>& v) {
+        assign(v.begin(), v.end());
+        return *this;
+    }
+
+    /* 访问 */
+
+    T* data() { return reinterpret_cast<T*>(storage); }
+    const T* data() const { return reinterpret_cast<const T*>(storage); }
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    T& front() { return data()[0]; }
+    const T& front() const { return data()[0]; }
+    T& back() { return data()[count - 1]; }
+    const T& back() const { return data()[count - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    static constexpr size_t capacity() { return N; }
+    void reserve(size_t n) { assert(n <= N); }
+
+    /* 修改 */
+
+    void clear() { count = 0; }
+
+    void push_back(const T& x) {
+        assert(count < N);
+        std::memcpy(static_cast<void*>(data() + count), &x, sizeof(T));
+        count++;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        assert(count < N);
+        T* p = new (data() + count) T(std::forward<Args>(args)...);
+        count++;
+        return *p;
+    }
+
+    void pop_back() { count--; }
+
+    // 在pos前插入x，返回指向新元素的迭代器
+    iterator insert(const_iterator pos, const T& x) {
+        assert(count < N);
+        T* p = const_cast<T*>(pos);
+        T tmp = x; // x可能就是容器内的元素
+        std::memmove(static_cast<void*>(p + 1), p, (end() - p) * sizeof(T));
+        std::memcpy(static_cast<void*>(p), &tmp, sizeof(T));
+        count++;
+        return p;
+    }
+
+    iterator emplace(const_iterator pos, const T& x) { return insert(pos, x); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        T* p = const_cast<T*>(first);
+        std::memmove(static_cast<void*>(p), last, (end() - last) * sizeof(T));
+        count -= last - first;
+        return p;
+    }
+
+    template<typename It>
+    void assign(It first, It last) {
+        clear();
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    // 转换为std::vector，供需要独立副本的接口使用
+    operator std::vector<T>() const { return std::vector<T>(begin(), end()); }
+
+    friend bool operator==(const Fixed_vector& a, const Fixed_vector& b) {
+        if (a.count != b.count) return false;
+        for (int i = 0; i < a.count; i++) if (!(a[i] == b[i])) return false;
+        return true;
+    }
+    friend bool operator!=(const Fixed_vector& a, const Fixed_vector& b) { return !(a == b); }
+
+    private:
+    friend class Undo_log; // 只记录计数及已使用的元素
+    int count = 0;
+    alignas(T) unsigned char storage[N * sizeof(T)];
+};
@@ -18,6 +18,16 @@
 #include <fstream>
 #include <iomanip>
 #include "common.hpp"
+#include "undo_log.hpp"
+
+/**
+ * @brief Max number of towers on the map (BUILD_COST allows 7 towers for each side).
+ */
+static constexpr int MAX_TOWER_NUM = 2 * (sizeof(BUILD_COST) / sizeof(BUILD_COST[0]) - 1);
+/**
+ * @brief Max number of super weapons being used (at most one of each type for each side).
+ */
+static constexpr int MAX_SUPER_WEAPON_NUM = 2 * (SuperWeaponCount - 1);
 
 /**
  * @brief A module used for game state management, providing interfaces for accessing and modifying 
@@ -26,12 +36,13 @@
 struct GameInfo
 {
     int round;                                      ///< Current round number
-    std::vector<Tower> towers;                      ///< All towers on the map
-    std::vector<Ant> ants;                          ///< All ants on the map
+    Fixed_vector<Tower, MAX_TOWER_NUM> towers;      ///< All towers on the map
+    Ant_list ants;                                  ///< All ants on the map
     Base bases[2];                                  ///< Bases of both sides: "bases[player_id]"
     int coins[2];                                   ///< Coins of both sides: "coins[player_id]"
     double pheromone[2][MAP_SIZE][MAP_SIZE];        ///< Pheromone of each point on the map: "pheromone[player_id][x][y]"
-    std::vector<SuperWeapon> super_weapons;         ///< Super weapons being used
+    Fixed_vector<SuperWeapon, MAX_SUPER_WEAPON_NUM> super_weapons; ///< Super weapons being used
+    Cell_set super_weapon_areas[2][EmergencyEvasion]; ///< Area of effect of super weapons being used: "super_weapon_areas[player_id][type]" (EmergencyEvasion takes effect at once and has none)
     int super_weapon_cd[2][SuperWeaponCount];       ///< Super weapon cooldown of both sides: "super_weapon_cd[player_id]"
     
     int next_ant_id;                                ///< ID of the next generated ant.
@@ -54,13 +65,13 @@ struct GameInfo
     /* Getters */
 
     /**
-     * @brief Find no more than one element in the given vector for which a predicate is true.
-     * @param v A vector.
+     * @brief Find no more than one element in the given container for which a predicate is true.
+     * @param v A container, e.g. "towers" or "ants".
      * @param pred A predicate. 
      * @return An optional object whose value satisfies "pred" or nullopt if not found. 
      */
-    template<typename T, typename Pred>
-    std::optional<T> find_one(const std::vector<T>& v, Pred pred) const
+    template<typename C, typename Pred, typename T = typename C::value_type>
+    std::optional<T> find_one(const C& v, Pred pred) const
     {
         auto it = std::find_if(v.begin(), v.end(), pred);
         if (it != v.end())
@@ -70,13 +81,13 @@ struct GameInfo
     }
     
     /**
-     * @brief Find all elements in the given vector for which a predicate is true.
-     * @param v A vector.
+     * @brief Find all elements in the given container for which a predicate is true.
+     * @param v A container, e.g. "towers" or "ants".
      * @param pred A predicate. 
      * @return A vector of copies of all elements for which "pred" is true. 
      */
-    template<typename T, typename Pred>
-    std::vector<T> find_all(const std::vector<T>& v, Pred pred) const
+    template<typename C, typename Pred, typename T = typename C::value_type>
+    std::vector<T> find_all(const C& v, Pred pred) const
     {
         std::vector<T> fit_elems;
         for (const T& e: v)
@@ -266,13 +277,11 @@ struct GameInfo
      */
     void clear_dead_and_succeeded_ants()
     {
-        for (auto it = ants.begin(); it != ants.end();)
-        {
-            if (it->state == AntState::Success || it->state == AntState::Fail || it->state == AntState::TooOld)
-                it = ants.erase(it);
-            else
-                ++it;
-        }
+        // Compact survivors in place, keeping their order
+        auto last = std::remove_if(ants.begin(), ants.end(), [](const Ant& a){
+            return a.state == AntState::Success || a.state == AntState::Fail || a.state == AntState::TooOld;
+        });
+        ants.erase(last, ants.end());
     }
 
     /**
@@ -373,16 +382,16 @@ struct GameInfo
                        && !is_shielded_by_emp(player_id, op.arg0, op.arg1);
             case UpgradeTower:
             {
-                auto t = tower_of_id(op.arg0);
-                return t && t.value().player == player_id
-                       && t.value().is_upgrade_type_valid(op.arg1) 
-                       && !is_shielded_by_emp(t.value());
+                auto t = std::find_if(towers.begin(), towers.end(), [&](const Tower& t) { return t.id == op.arg0; });
+                return t != towers.end() && t->player == player_id
+                       && t->is_upgrade_type_valid(op.arg1) 
+                       && !is_shielded_by_emp(*t);
             }
             case DowngradeTower:
             {
-                auto t = tower_of_id(op.arg0);
-                return t && t.value().player == player_id
-                       && !is_shielded_by_emp(t.value());
+                auto t = std::find_if(towers.begin(), towers.end(), [&](const Tower& t) { return t.id == op.arg0; });
+                return t != towers.end() && t->player == player_id
+                       && !is_shielded_by_emp(*t);
             }
             case UseLightningStorm:
             case UseEmpBlaster:
@@ -405,62 +414,9 @@ struct GameInfo
      * @param player_id The player.
      * @param ops Operations already added, with the newly added one at the end.
      * @return Whether the operation is valid.
+     * @see Op_validator for checking operations one by one.
      */
-    bool is_operation_valid(int player_id, const std::vector<Operation>& ops, const Operation& new_op) const
-    {
-        // Check if there are multiple operations of the same type
-        bool collide = false;
-        switch (new_op.type)
-        {
-            // At specified position only one tower can be built
-            case OperationType::BuildTower:
-                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
-                    return op.type == BuildTower && op.arg0 == new_op.arg0 && op.arg1 == new_op.arg1;
-                });
-                break;
-            // A tower can only be upgraded/downgraded once
-            case OperationType::UpgradeTower:
-            case OperationType::DowngradeTower:
-                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
-                    return (op.type == UpgradeTower || op.type == DowngradeTower) && op.arg0 == new_op.arg0;
-                });
-                break;
-            // Base can only be upgraded once
-            case OperationType::UpgradeGeneratedAnt:
-            case OperationType::UpgradeGenerationSpeed:
-                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
-                    return op.type == UpgradeGeneratedAnt || op.type == UpgradeGenerationSpeed;
-                });
-                break;
-            // Super weapon of specified type can only be used once
-            case OperationType::UseLightningStorm:
-            case OperationType::UseEmpBlaster:
-            case OperationType::UseDeflector:
-            case OperationType::UseEmergencyEvasion:
-                collide = std::any_of(ops.begin(), ops.end(), [&](const Operation& op) {
-                    return op.type == new_op.type;
-                });
-                break;
-            // Illegal operation type
-            default:
-                return false;
-        }
-        if (collide)
-            return false;
-
-        // Check operation validness
-        if (!is_operation_valid(player_id, new_op))
-            return false;
-        
-        // Check if the player has enough coins
-        std::vector<Operation> new_ops(ops);
-        new_ops.push_back(new_op);
-        if (!check_affordable(player_id, new_ops))
-            return false;
-
-        // Pass all checks. The operation has been added successfully.
-        return true;
-    }
+    bool is_operation_valid(int player_id, const std::vector<Operation>& ops, const Operation& new_op) const;
 
     /**
      * @brief Get the income of an operation BEFORE applied. The income could be
@@ -576,6 +532,45 @@ struct GameInfo
         }
     }
 
+    /**
+     * @brief The same as apply_operation(player_id, op), recording the state it changes to "log" beforehand.
+     * @param player_id Whose operation.
+     * @param op The operation to be applied.
+     * @param log The undo log.
+     */
+    void apply_operation(int player_id, const Operation& op, Undo_log& log)
+    {
+        log.save(coins[player_id]);
+        switch (op.type)
+        {
+            case BuildTower:
+                log.save(towers);
+                log.save(next_tower_id);
+                break;
+            case UpgradeTower:
+            case DowngradeTower:
+                log.save(towers);
+                break;
+            case UseLightningStorm:
+            case UseEmpBlaster:
+            case UseDeflector:
+            case UseEmergencyEvasion:
+                log.save(super_weapons);
+                log.save(super_weapon_areas[player_id]);
+                log.save(super_weapon_cd[player_id]);
+                if (op.type == UseEmergencyEvasion)
+                    for (Ant& ant : ants)
+                        if (ant.player == player_id)
+                            log.save(ant.evasion);
+                break;
+            case UpgradeGenerationSpeed:
+            case UpgradeGeneratedAnt:
+                log.save(bases[player_id]);
+                break;
+        }
+        apply_operation(player_id, op);
+    }
+
     /* ACO predictors */
 
     /**
@@ -731,15 +726,19 @@ struct GameInfo
         // Apply EmergercyEvasion directly
         if (sw.type == EmergencyEvasion)
         {
+            const Cell_set& area = sw.area();
             for (Ant &ant : ants)
             {
-                if (sw.is_in_range(ant.x, ant.y) && ant.player == sw.player)
+                if (ant.player == sw.player && area.test(cell_index(ant.x, ant.y)))
                     ant.evasion = 2;
             }
         }
         // Add to super weapon list for other super weapons
         else
+        {
+            super_weapon_areas[player][type] |= sw.area();
             super_weapons.emplace_back(std::move(sw));
+        }
         // Reset cd
         super_weapon_cd[player][type] = SUPER_WEAPON_INFO[type][2];
     }
@@ -750,9 +749,7 @@ struct GameInfo
      */
     bool is_shielded_by_emp(int player_id, int x, int y) const
     {
-        return std::any_of(super_weapons.begin(), super_weapons.end(), [player_id, x, y](const SuperWeapon& weapon){
-            return weapon.type == EmpBlaster && weapon.player != player_id && weapon.is_in_range(x, y);
-        });
+        return super_weapon_areas[!player_id][EmpBlaster].test(cell_index(x, y));
     }
 
     /**
@@ -770,9 +767,40 @@ struct GameInfo
      */
     bool is_shielded_by_deflector(const Ant& a) const
     {
-        return std::any_of(super_weapons.begin(), super_weapons.end(), [a](const SuperWeapon& weapon){
-            return weapon.type == Deflector && weapon.player == a.player && weapon.is_in_range(a.x, a.y);
-        });
+        return super_weapon_areas[a.player][Deflector].test(cell_index(a.x, a.y));
+    }
+
+    /**
+     * @brief Check whether an ant is in the range of an opponent's LightningStorm.
+     * @return Whether the ant is struck.
+     */
+    bool is_struck_by_lightning(const Ant& a) const
+    {
+        return super_weapon_areas[!a.player][LightningStorm].test(cell_index(a.x, a.y));
+    }
+
+    /**
+     * @brief Rebuild "super_weapon_areas" of a player from "super_weapons".
+     * @note Called automatically by use_super_weapon() and count_down_super_weapons_left_time(). 
+     * Call it after modifying "super_weapons" directly.
+     */
+    void update_super_weapon_areas(int player_id)
+    {
+        for (Cell_set& area : super_weapon_areas[player_id])
+            area.reset();
+        for (const SuperWeapon& sw : super_weapons)
+            if (sw.player == player_id)
+                super_weapon_areas[player_id][sw.type] |= sw.area();
+    }
+
+    /**
+     * @brief Rebuild "super_weapon_areas" of both sides.
+     * @see update_super_weapon_areas(int)
+     */
+    void update_super_weapon_areas()
+    {
+        for (int i = 0; i < 2; ++i)
+            update_super_weapon_areas(i);
     }
 
     /**
@@ -780,6 +808,7 @@ struct GameInfo
      */
     void count_down_super_weapons_left_time(int player_id)
     {
+        bool expired = false;
         for (auto it = super_weapons.begin(); it != super_weapons.end(); )
         {
             if (it->player != player_id)
@@ -791,10 +820,25 @@ struct GameInfo
             it->left_time--;
             // Clear if timeout
             if (it->left_time <= 0)
+            {
                 it = super_weapons.erase(it);
+                expired = true;
+            }
             else
                 ++it;
         }
+        if (expired)
+            update_super_weapon_areas(player_id);
+    }
+
+    /**
+     * @brief The same as count_down_super_weapons_left_time(player_id), recording the state it changes to "log" beforehand.
+     */
+    void count_down_super_weapons_left_time(int player_id, Undo_log& log)
+    {
+        log.save(super_weapons);
+        log.save(super_weapon_areas[player_id]);
+        count_down_super_weapons_left_time(player_id);
     }
 
     /**
@@ -891,3 +935,199 @@ struct GameInfo
         fout.close();
     }
 };
+
+// 局面的复制（如Simulator的构造）只是一次memcpy
+static_assert(std::is_trivially_copyable_v<GameInfo>, "GameInfo must stay trivially copyable");
+
+/**
+ * @brief Incremental version of GameInfo::is_operation_valid(player_id, ops, new_op) for a growing
+ * operation list. Collisions, the player's tower count and coin balance are kept up to date as
+ * operations are added, so checking an operation takes constant time and no allocation.
+ * @note The game state must not change while the validator is in use.
+ */
+class Op_validator
+{
+public:
+    /**
+     * @brief Start with an empty operation list.
+     * @param info The game state the operations are to be applied to.
+     * @param player_id The player.
+     */
+    Op_validator(const GameInfo& info, int player_id)
+        : info(info), player_id(player_id), tower_num(0), balance(info.coins[player_id])
+    {
+        for (const Tower& t : info.towers)
+        {
+            occupied.set(cell_index(t.x, t.y));
+            if (t.player == player_id)
+                tower_num++;
+        }
+    }
+
+    /**
+     * @brief Check whether an operation can be added to the list.
+     * @return The same as GameInfo::is_operation_valid(player_id, ops, op), where "ops" is the current list.
+     */
+    bool check(const Operation& op) const
+    {
+        switch (op.type)
+        {
+            case BuildTower:
+                return is_highland(player_id, op.arg0, op.arg1)
+                       && !built.test(cell_index(op.arg0, op.arg1))
+                       && !occupied.test(cell_index(op.arg0, op.arg1))
+                       && !info.is_shielded_by_emp(player_id, op.arg0, op.arg1)
+                       && balance - GameInfo::build_tower_cost(tower_num) >= 0;
+            case UpgradeTower:
+            case DowngradeTower:
+            {
+                int i = tower_index(op.arg0);
+                if (i < 0 || touched[i])
+                    return false;
+                const Tower& t = info.towers[i];
+                if (t.player != player_id || info.is_shielded_by_emp(t))
+                    return false;
+                if (op.type == UpgradeTower)
+                    return t.is_upgrade_type_valid(op.arg1) && balance - GameInfo::upgrade_tower_cost(op.arg1) >= 0;
+                return balance + downgrade_income(t) >= 0;
+            }
+            case UseLightningStorm:
+            case UseEmpBlaster:
+            case UseDeflector:
+            case UseEmergencyEvasion:
+                return !(weapons_used >> (op.type % 10) & 1)
+                       && info.is_operation_valid(player_id, op)
+                       && balance - GameInfo::use_super_weapon_cost(op.type % 10) >= 0;
+            case UpgradeGenerationSpeed:
+            case UpgradeGeneratedAnt:
+                return !base_upgraded
+                       && info.is_operation_valid(player_id, op)
+                       && balance + info.get_operation_income(player_id, op) >= 0;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @brief Add an operation to the list without checking it.
+     */
+    void push(const Operation& op)
+    {
+        switch (op.type)
+        {
+            case BuildTower:
+                if (is_highland(player_id, op.arg0, op.arg1))
+                    built.set(cell_index(op.arg0, op.arg1));
+                balance -= GameInfo::build_tower_cost(tower_num++);
+                break;
+            case UpgradeTower:
+            case DowngradeTower:
+            {
+                int i = tower_index(op.arg0);
+                if (i >= 0)
+                    touched[i] = true;
+                if (op.type == UpgradeTower)
+                    balance -= GameInfo::upgrade_tower_cost(op.arg1);
+                else if (i >= 0)
+                {
+                    balance += downgrade_income(info.towers[i]);
+                    if (info.towers[i].type == TowerType::Basic)
+                        tower_num--;
+                }
+                break;
+            }
+            case UseLightningStorm:
+            case UseEmpBlaster:
+            case UseDeflector:
+            case UseEmergencyEvasion:
+                weapons_used |= 1 << (op.type % 10);
+                balance -= GameInfo::use_super_weapon_cost(op.type % 10);
+                break;
+            case UpgradeGenerationSpeed:
+            case UpgradeGeneratedAnt:
+                base_upgraded = true;
+                balance += info.get_operation_income(player_id, op);
+                break;
+        }
+    }
+
+    /**
+     * @brief Add an operation to the list if it passes check().
+     * @return Whether the operation is added.
+     */
+    bool append(const Operation& op)
+    {
+        if (!check(op))
+            return false;
+        push(op);
+        return true;
+    }
+
+private:
+    const GameInfo& info;
+    int player_id;
+    int tower_num;                          ///< Towers of the player after the listed operations
+    int balance;                            ///< Coins of the player after the listed operations
+    Cell_set occupied;                      ///< Points with a tower
+    Cell_set built;                         ///< Points with a listed BuildTower
+    bool touched[MAX_TOWER_NUM] = {};       ///< Whether "info.towers[i]" has a listed upgrade/downgrade
+    unsigned weapons_used = 0;              ///< Bit "type" for each listed super weapon
+    bool base_upgraded = false;             ///< Whether there is a listed base upgrade
+
+    int tower_index(int id) const
+    {
+        for (int i = 0; i < info.towers.size(); ++i)
+            if (info.towers[i].id == id)
+                return i;
+        return -1;
+    }
+
+    int downgrade_income(const Tower& t) const
+    {
+        if (t.type == TowerType::Basic) // To be destroyed
+            return GameInfo::destroy_tower_income(tower_num);
+        else // To be downgraded
+            return GameInfo::downgrade_tower_income(t.type);
+    }
+};
+
+/**
+ * @brief Memo of GameInfo::next_move under a fixed pheromone field. The direction only depends on the player,
+ * the position of the ant and its last move, so ants sharing these get it from a single evaluation.
+ * Entries are computed on first use.
+ * @note The pheromone must not change while the table is in use.
+ */
+class Move_table
+{
+public:
+    explicit Move_table(const GameInfo& info) : info(info) {}
+
+    /**
+     * @brief Get next moving direction for an ant.
+     * @return The same as GameInfo::next_move(ant).
+     */
+    int next_move(const Ant& ant)
+    {
+        int last = ant.path.empty() ? 6 : ant.path.back();
+        int cell = cell_index(ant.x, ant.y);
+        if (!known[ant.player][last].test(cell))
+        {
+            known[ant.player][last].set(cell);
+            direction[ant.player][last][cell] = info.next_move(ant);
+        }
+        return direction[ant.player][last][cell];
+    }
+
+private:
+    const GameInfo& info;
+    Cell_set known[2][7];                           ///< Computed entries: "known[player][last move]", with 6 for no move yet
+    signed char direction[2][7][Bitboard::SIZE];    ///< Valid only where "known" is set, thus left uninitialized
+};
+
+inline bool GameInfo::is_operation_valid(int player_id, const std::vector<Operation>& ops, const Operation& new_op) const
+{
+    Op_validator validator(*this, player_id);
+    for (const Operation& op : ops)
+        validator.push(op);
+    return validator.check(new_op);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "referee.hpp"
+
+// 一局进程内对局的结果
+struct Headless_result {
+    unsigned long long seed = 0;
+    int winner = -1; // 胜者编号，平局为-1
+    std::string reason;
+    int rounds = 0;
+    int hp[2] = {}, kills[2] = {};
+    std::vector<double> decision_ms[2]; // 双方每次决策的用时(ms)
+};
+
+/**
+ * 进程内对局：双方AI直接在裁判的权威局面上调用ai_call_routine，不经过任何IO
+ *
+ * AI需提供与AI_相同的接口：
+ *   const std::vector<Operation>& ai_call_routine(int player_id, const GameInfo&, const std::vector<Operation>& opponent_op);
+ * 调用顺序与真实对局一致：player0基于回合开始时的局面决策，player1基于已执行player0操作的局面决策。
+ * 权威局面中的Tower::cd及Ant::evasion均为真实值，因此无需run_ai中的预处理模块。
+ */
+template<typename AI>
+class Headless_match {
+    public:
+    Referee referee;
+
+    Headless_match(unsigned long long seed, AI& ai0, AI& ai1) : referee(seed), ai{&ai0, &ai1} {
+        result.seed = seed;
+    }
+
+    /**
+     * @brief 进行一个回合
+     * @return bool 对局是否仍在进行
+     */
+    bool step() {
+        for (int p = 0; p < 2 && !referee.finished; p++) {
+            auto start = std::chrono::steady_clock::now();
+            ops[p] = ai[p]->ai_call_routine(p, referee.info(), ops[!p]);
+            result.decision_ms[p].push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            referee.apply_operations(p, ops[p]);
+        }
+        return referee.settle();
+    }
+
+    // 进行完整的一局
+    const Headless_result& run() {
+        while (step());
+        result.winner = referee.winner;
+        result.reason = referee.reason;
+        result.rounds = referee.info().round;
+        for (int p = 0; p < 2; p++) {
+            result.hp[p] = referee.info().bases[p].hp;
+            result.kills[p] = referee.kills[p];
+        }
+        return result;
+    }
+
+    private:
+    AI* ai[2];
+    std::vector<Operation> ops[2]; // 双方最近一次的操作，作为对方下一次决策的opponent_op
+    Headless_result result;
+};
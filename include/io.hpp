@@ -32,32 +32,48 @@ inline InitInfo read_init_info()
     return {self_player_id, seed};
 }
 
+/**
+ * @brief Upper bound on the number of operations in one message. A legal operation list is far
+ * shorter; anything longer can only come from a broken peer.
+ */
+static constexpr int MAX_OPERATION_NUM = MAP_SIZE * MAP_SIZE;
+
 /**
  * @brief Read your opponent's operations and deserialize them. The time to call this
  * function depends on your player ID.
+ * @param in (Optional) The stream to read from, with std::cin as default.
  * @return A vector of Operation objects.
+ * @note A count outside [0, MAX_OPERATION_NUM] sets the failbit of `in` and returns no operation,
+ * so that callers reading untrusted output (e.g. the judger) can rule it malformed.
  */
-inline std::vector<Operation> read_opponent_operations()
+inline std::vector<Operation> read_opponent_operations(std::istream& in = std::cin)
 {
     std::vector<Operation> ops;
     int count, type, arg0, arg1 = -1;
-    std::cin >> count;
+    in >> count;
+    if (!in)
+        return ops;
+    if (count < 0 || count > MAX_OPERATION_NUM)
+    {
+        in.setstate(std::ios::failbit);
+        return ops;
+    }
     ops.reserve(count);
     for (int i = 0; i < count; i++)
     {
-        std::cin >> type;
+        in >> type;
         if (type == UpgradeGeneratedAnt || type == UpgradeGenerationSpeed)
         {
             ops.emplace_back(static_cast<OperationType>(type));   
         }
         else if (type == DowngradeTower)
         {
-            std::cin >> arg0;
+            in >> arg0;
             ops.emplace_back(static_cast<OperationType>(type), arg0);
         }
         else
         {
-            std::cin >> arg0 >> arg1;
+            in >> arg0 >> arg1;
             ops.emplace_back(static_cast<OperationType>(type), arg0, arg1);
         }
     }
@@ -84,6 +100,8 @@ inline RoundInfo read_round_info()
     RoundInfo info;
     // Round ID
     std::cin >> info.round;
+    if (!std::cin) // End of input (e.g. when replaying a captured input)
+        return info;
     // Variables
     int id, player, x, y, type, cd, hp, level, age, state;
     // Tower
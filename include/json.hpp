@@ -0,0 +1,171 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+
+// 极简JSON读取器，仅用于工具读取回放文件，不追求完整的标准支持
+class Json {
+    public:
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double number = 0;
+    std::string str;
+    std::vector<Json> arr;
+    std::vector<std::pair<std::string, Json>> obj;
+
+    /**
+     * @brief 解析给定的JSON文本
+     * @param text 待解析的文本
+     * @param ok 解析是否成功
+     * @return Json 解析得到的根节点，失败时为Null
+     */
+    static Json parse(const std::string& text, bool& ok) {
+        const char* p = text.c_str();
+        const char* end = p + text.size();
+        Json ret;
+        ok = parse_value(p, end, ret);
+        skip_space(p, end);
+        ok &= (p == end);
+        if (!ok) ret = Json();
+        return ret;
+    }
+
+    bool is_null() const { return type == Null; }
+    bool is_array() const { return type == Array; }
+    bool is_object() const { return type == Object; }
+
+    // 查找对象中的字段，不存在时返回NULL
+    const Json* find(const char* key) const {
+        for (const auto& kv : obj) if (kv.first == key) return &kv.second;
+        return nullptr;
+    }
+    // 查找对象中的字段，不存在时返回一个Null节点
+    const Json& operator[](const char* key) const {
+        const Json* ans = find(key);
+        return ans ? *ans : null_node();
+    }
+    const Json& at(size_t idx) const {
+        return idx < arr.size() ? arr[idx] : null_node();
+    }
+    size_t size() const {
+        return type == Array ? arr.size() : obj.size();
+    }
+
+    int as_int(int dflt = 0) const {
+        if (type == Number) return (int)number;
+        if (type == Bool) return boolean;
+        return dflt;
+    }
+    double as_double(double dflt = 0) const {
+        return type == Number ? number : dflt;
+    }
+    unsigned long long as_ull(unsigned long long dflt = 0) const {
+        if (type == Number) return (unsigned long long)number;
+        if (type == String) return std::strtoull(str.c_str(), nullptr, 10);
+        return dflt;
+    }
+
+    private:
+    static const Json& null_node() {
+        static const Json node;
+        return node;
+    }
+    static void skip_space(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+    static bool parse_value(const char*& p, const char* end, Json& out) {
+        skip_space(p, end);
+        if (p >= end) return false;
+        switch (*p) {
+            case '{': return parse_object(p, end, out);
+            case '[': return parse_array(p, end, out);
+            case '"': out.type = String; return parse_string(p, end, out.str);
+            case 't': return parse_literal(p, end, "true", out, Bool, true);
+            case 'f': return parse_literal(p, end, "false", out, Bool, false);
+            case 'n': return parse_literal(p, end, "null", out, Null, false);
+            default: return parse_number(p, end, out);
+        }
+    }
+    static bool parse_literal(const char*& p, const char* end, const char* word, Json& out, Type tp, bool val) {
+        size_t len = std::strlen(word);
+        if ((size_t)(end - p) < len || std::strncmp(p, word, len)) return false;
+        p += len;
+        out.type = tp;
+        out.boolean = val;
+        return true;
+    }
+    static bool parse_number(const char*& p, const char* end, Json& out) {
+        char* num_end = nullptr;
+        out.number = std::strtod(p, &num_end);
+        if (num_end == p || num_end > end) return false;
+        out.type = Number;
+        p = num_end;
+        return true;
+    }
+    static bool parse_string(const char*& p, const char* end, std::string& out) {
+        p++; // 跳过开头的引号
+        while (p < end && *p != '"') {
+            if (*p == '\\') {
+                if (++p >= end) return false;
+                switch (*p) {
+                    case 'n': out.push_back('\n'); break;
+                    case 't': out.push_back('\t'); break;
+                    case 'r': out.push_back('\r'); break;
+                    case 'b': out.push_back('\b'); break;
+                    case 'f': out.push_back('\f'); break;
+                    case 'u': // 回放中不会出现需要关心的非ASCII字段，简单跳过
+                        if (end - p < 5) return false;
+                        p += 4;
+                        out.push_back('?');
+                        break;
+                    default: out.push_back(*p);
+                }
+                p++;
+            } else out.push_back(*p++);
+        }
+        if (p >= end) return false;
+        p++;
+        return true;
+    }
+    static bool parse_array(const char*& p, const char* end, Json& out) {
+        out.type = Array;
+        p++;
+        skip_space(p, end);
+        if (p < end && *p == ']') return ++p, true;
+        while (p < end) {
+            out.arr.emplace_back();
+            if (!parse_value(p, end, out.arr.back())) return false;
+            skip_space(p, end);
+            if (p < end && *p == ',') p++;
+            else if (p < end && *p == ']') return ++p, true;
+            else return false;
+        }
+        return false;
+    }
+    static bool parse_object(const char*& p, const char* end, Json& out) {
+        out.type = Object;
+        p++;
+        skip_space(p, end);
+        if (p < end && *p == '}') return ++p, true;
+        while (p < end) {
+            skip_space(p, end);
+            if (p >= end || *p != '"') return false;
+            out.obj.emplace_back();
+            if (!parse_string(p, end, out.obj.back().first)) return false;
+            skip_space(p, end);
+            if (p >= end || *p != ':') return false;
+            p++;
+            if (!parse_value(p, end, out.obj.back().second)) return false;
+            skip_space(p, end);
+            if (p < end && *p == ',') p++;
+            else if (p < end && *p == '}') return ++p, true;
+            else return false;
+        }
+        return false;
+    }
+};
@@ -37,7 +37,7 @@ class Logger {
 };
 
 std::string str_wrap(const char* format, ...) {
-	static char buffer[256];
+	static thread_local char buffer[256];
 	va_list args;
 	va_start(args, format);
 	vsprintf(buffer, format, args);
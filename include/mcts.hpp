@@ -0,0 +1,279 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "simulate.hpp"
+#include "operation.hpp"
+#include "checker.hpp"
+
+// MCTS的配置
+struct Mcts_cfg {
+    double budget_ms = 200; // 每次搜索的墙钟时间预算（毫秒）
+    int max_iterations = 0; // 每次搜索的迭代数上限，为0时不限（仅受时间预算约束）
+    int threads = 0; // 搜索线程数，为0时使用全部核心
+    int horizon = 20; // 自搜索根起的评估回合数，树中的路径加上无操作的rollout共推演这么多回合
+    double exploration = 0.7; // UCT的探索系数
+    double widen_c = 1.0, widen_alpha = 0.5; // 渐进展宽：访问n次的节点至多展开1+widen_c*n^widen_alpha个动作
+    double econ_weight = 0.01; // 局面评估中每枚金币（含塔的固定资产）相当于多少点血量
+    bool super_weapons = true; // 候选动作是否包含超级武器
+};
+
+// 一次搜索的结果
+struct Mcts_result {
+    std::vector<Task> ops; // 选出的动作序列（相对时间），空表示不操作
+    int iterations = 0; // 本次搜索的迭代数
+    int visits = 0; // 选出的动作的访问次数
+    double value = 0.5; // 选出的动作的平均评估值，越大对我方越有利
+    bool reused = false; // 是否沿用了上一次搜索的子树
+};
+
+/**
+ * 以Op_generator的候选动作为边的蒙特卡洛树搜索
+ *
+ * 每回合分为两层：我方节点（保存我方决策时的Simulator）选择我方动作，对方节点选择对方动作，
+ * 双方动作确定后推进一回合得到下一个我方节点。两层均按渐进展宽从候选的前部逐个展开，
+ * 新节点以双方均不操作的rollout评估至固定的视野，评估值为血量差及资产差的变化经logistic映射到(0, 1)。
+ * 多个线程共享一棵树（树并行），选择、挂载及回传在锁内进行，推演及rollout在锁外进行，以虚拟损失分散线程。
+ * 下一回合以实际局面的state_hash在上次选出的动作之下查找对应的子树并沿用。
+ */
+class Mcts {
+    public:
+    Mcts_cfg cfg;
+
+    explicit Mcts(int pid, Mcts_cfg cfg = {}) : cfg(cfg), pid(pid) {}
+
+    // 丢弃整棵树
+    void reset() {
+        root.reset();
+        last_choice = -1;
+    }
+
+    /**
+     * @brief 自给定局面搜索我方的动作
+     * @param info 当前局面，应为我方的决策时刻
+     * @return Mcts_result 搜索结果
+     */
+    Mcts_result search(const GameInfo& info) {
+        Mcts_result ans;
+        ans.reused = advance(info);
+        if (!ans.reused) {
+            Simulator sim(info, pid);
+            base_score = 0;
+            base_score = score(sim.info);
+            root = make_node(std::move(sim), 0, pid);
+        }
+        root_depth = root->depth;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(int64_t(cfg.budget_ms * 1000));
+        int threads = cfg.threads > 0 ? cfg.threads : std::max(1u, std::thread::hardware_concurrency());
+        iterations = 0;
+        std::vector<std::thread> pool;
+        for (int i = 1; i < threads; i++) pool.emplace_back([&] { work(deadline); });
+        work(deadline);
+        for (std::thread& t : pool) t.join();
+
+        // 选出访问次数最多的动作
+        last_choice = -1;
+        for (int i = 0; i < root->children.size(); i++) {
+            const Node* c = root->children[i].get();
+            if (c && (last_choice < 0 || c->visits > root->children[last_choice]->visits)) last_choice = i;
+        }
+        ans.iterations = iterations;
+        if (last_choice >= 0) {
+            const Node* c = root->children[last_choice].get();
+            ans.ops = root->cands[last_choice];
+            ans.visits = c->visits;
+            ans.value = c->value / std::max(c->visits, 1);
+        }
+        return ans;
+    }
+
+    private:
+    struct Node {
+        std::unique_ptr<Simulator> sim; // 仅我方节点保存局面
+        int depth; // 自最初的根起推进的回合数，也即task_list中相对时间的起点
+        int player; // 在此节点行动的玩家
+        std::vector<std::vector<Task>> cands; // 候选动作，cands[0]总是不操作
+        std::vector<std::unique_ptr<Node>> children; // 与cands一一对应，未展开时为空
+        std::vector<bool> reserved; // 是否已有线程在展开对应的子节点
+        int visits = 0; // 含进行中的虚拟访问
+        double value = 0; // 评估值之和（我方视角），含虚拟损失
+    };
+
+    const int pid;
+    std::unique_ptr<Node> root;
+    int root_depth = 0;
+    int last_choice = -1; // 上一次搜索在根处选出的动作
+    double base_score = 0; // 建树时局面的血量及资产差，评估均相对于此
+    int iterations = 0;
+    std::mutex mutex;
+
+    // 以实际局面沿用上一次搜索的子树，返回是否成功
+    bool advance(const GameInfo& info) {
+        if (!root || last_choice < 0 || !root->children[last_choice]) return false;
+        std::unique_ptr<Node>& opp = root->children[last_choice];
+        uint64_t hash = state_hash(info);
+        for (std::unique_ptr<Node>& c : opp->children) {
+            if (!c || c->sim->info.round != info.round || state_hash(c->sim->info) != hash) continue;
+            std::unique_ptr<Node> next = std::move(c);
+            root = std::move(next);
+            return true;
+        }
+        return false;
+    }
+
+    // 血量差及资产差（我方视角）
+    double score(const GameInfo& info) const {
+        double hp = info.bases[pid].hp - info.bases[!pid].hp;
+        return hp + cfg.econ_weight * (asset(info, pid) - asset(info, !pid)) - base_score;
+    }
+    static int asset(const GameInfo& info, int player) {
+        int ans = info.coins[player] + ACCU_REFUND[info.tower_num_of_player(player)];
+        for (const Tower& t : info.towers) if (t.player == player) ans += LEVEL_REFUND[t.level()];
+        return ans;
+    }
+
+    // 生成player在info下的候选动作
+    std::vector<std::vector<Task>> candidates(const GameInfo& info, int player) const {
+        std::vector<std::vector<Task>> ans{{}};
+        if (info.round >= MAX_ROUND) return ans;
+        Op_generator gen(info, player);
+        if (cfg.super_weapons) gen << LS_cfg{true} << EVA_cfg{true} << EMP_cfg{true};
+        gen.generate_operations();
+        std::stable_sort(gen.ops.begin(), gen.ops.end(), [](const Defense_operation& a, const Defense_operation& b) { return a.loss < b.loss; });
+        for (const Defense_operation& op : gen.ops) if (op.ops.size() && info.round + op.round_needed < MAX_ROUND) ans.push_back(op.ops);
+        return ans;
+    }
+
+    std::unique_ptr<Node> make_node(std::unique_ptr<Simulator> sim, int depth, int player, const GameInfo& info) const {
+        auto node = std::make_unique<Node>();
+        node->sim = std::move(sim);
+        node->depth = depth;
+        node->player = player;
+        node->cands = candidates(info, player);
+        node->children.resize(node->cands.size());
+        node->reserved.resize(node->cands.size());
+        return node;
+    }
+    std::unique_ptr<Node> make_node(Simulator&& sim, int depth, int player) const {
+        auto p = std::make_unique<Simulator>(std::move(sim));
+        const GameInfo& info = p->info;
+        return make_node(std::move(p), depth, player, info);
+    }
+
+    // 自我方节点的局面执行双方动作并推进一回合
+    static std::unique_ptr<Simulator> transit(const Simulator& from, int depth, const std::vector<Task>& mine, const std::vector<Task>& theirs) {
+        auto sim = std::make_unique<Simulator>(from);
+        for (int p = 0; p < 2; p++) for (Task t : p == sim->pid ? mine : theirs) {
+            t.round += depth;
+            sim->task_list[p].push_back(t);
+        }
+        sim->step_simulation(1, depth);
+        return sim;
+    }
+
+    // 双方均不操作推演至视野末端，返回评估值
+    double rollout(const Simulator& from, int depth) const {
+        Simulator sim(from);
+        int remain = root_depth + cfg.horizon - depth;
+        if (remain > 0) sim.step_simulation(remain, depth);
+        return 1 / (1 + std::exp(-score(sim.info)));
+    }
+
+    // 在节点处选择要走的子节点，返回其下标；返回cands.size()+k表示展开第k个动作，返回-1表示暂无可走的动作
+    int select(const Node& node) const {
+        int allowed = std::min<int>(node.cands.size(), 1 + cfg.widen_c * std::pow(node.visits, cfg.widen_alpha));
+        int best = -1;
+        double best_ucb = -1;
+        for (int i = 0; i < allowed; i++) {
+            const Node* c = node.children[i].get();
+            if (!c) {
+                if (!node.reserved[i]) return node.cands.size() + i;
+                continue;
+            }
+            double mean = c->value / c->visits;
+            if (node.player != pid) mean = 1 - mean;
+            double ucb = mean + cfg.exploration * std::sqrt(std::log(node.visits + 1) / c->visits);
+            if (ucb > best_ucb) {
+                best_ucb = ucb;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // 以虚拟损失计入一次访问：对在parent处行动的玩家而言记为输
+    void visit(Node& node, const Node* parent) {
+        node.visits++;
+        if (parent && parent->player != pid) node.value += 1;
+    }
+
+    void work(std::chrono::steady_clock::time_point deadline) {
+        while (std::chrono::steady_clock::now() < deadline) {
+            struct Step { Node* node; Node* parent; int index; }; // index为node在parent中的下标
+            std::vector<Step> path;
+            int expand = -1;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (cfg.max_iterations > 0 && iterations >= cfg.max_iterations) return;
+                iterations++;
+                Node* node = root.get();
+                visit(*node, nullptr);
+                path.push_back({node, nullptr, -1});
+                while (true) {
+                    int k = select(*node);
+                    if (k < 0) break;
+                    if (k >= (int)node->cands.size()) {
+                        expand = k - node->cands.size();
+                        node->reserved[expand] = true;
+                        break;
+                    }
+                    Node* child = node->children[k].get();
+                    visit(*child, node);
+                    path.push_back({child, node, k});
+                    node = child;
+                }
+            }
+
+            // 锁外推演：展开新节点并rollout
+            Node* leaf = path.back().node;
+            std::unique_ptr<Node> fresh, grand;
+            double v;
+            if (expand < 0) { // 叶子已无可展开的动作（视野末端或其余线程正在展开），直接评估
+                const Node* mine = leaf->sim ? leaf : path.back().parent;
+                v = rollout(*mine->sim, mine->depth);
+            } else if (leaf->player == pid) {
+                // 我方动作：对方节点与我方节点共用局面，同时以对方不操作展开其第一个子节点
+                fresh = make_node(nullptr, leaf->depth, !pid, leaf->sim->info);
+                auto sim = transit(*leaf->sim, leaf->depth, leaf->cands[expand], fresh->cands[0]);
+                grand = make_node(std::move(*sim), leaf->depth + 1, pid);
+                v = rollout(*grand->sim, grand->depth);
+            } else {
+                const Node* mine = path.back().parent;
+                auto sim = transit(*mine->sim, mine->depth, mine->cands[path.back().index], leaf->cands[expand]);
+                fresh = make_node(std::move(*sim), mine->depth + 1, pid);
+                v = rollout(*fresh->sim, fresh->depth);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (fresh) {
+                if (grand) {
+                    grand->visits = 1;
+                    grand->value = v;
+                    fresh->children[0] = std::move(grand);
+                }
+                fresh->visits = 1;
+                fresh->value = v;
+                leaf->children[expand] = std::move(fresh);
+            }
+            // 回传，并撤销虚拟损失
+            for (const Step& s : path) s.node->value += v - (s.parent && s.parent->player != pid);
+        }
+    }
+};
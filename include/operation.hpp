@@ -2,9 +2,8 @@
 
 #include "game_info.hpp"
 #include "simulate.hpp"
-
-extern const GameInfo* info;
-extern int pid;
+#include "baseline.hpp"
+#include "sim_cache.hpp"
 
 // 动作序列类，模拟及比较功能将于日后分离出去
 class Operation_list {
@@ -17,8 +16,10 @@ class Operation_list {
     Sim_result res;
     double max_f_succ = 1e7;
 
-    explicit Operation_list(const std::vector<Operation>& _ops, int eval_round = -1, int _loss = 0, int _cost = 0, int _atk_side = -1)
-    : loss(_loss), cost(_cost), atk_side(_atk_side) {
+    Game_context* ctx; // 决策上下文，模拟将基于其中的局面及玩家编号进行
+
+    Operation_list(Game_context& _ctx, const std::vector<Operation>& _ops, int eval_round = -1, int _loss = 0, int _cost = 0, int _atk_side = -1)
+    : loss(_loss), cost(_cost), atk_side(_atk_side), ctx(&_ctx) {
         for (const Operation& op : _ops) append(op);
         if (eval_round >= 0) evaluate(eval_round);
     };
@@ -29,9 +30,21 @@ class Operation_list {
         if (op) append(op.value(), _round);
     }
 
-    const Sim_result& evaluate(int _round, int stopping_f_succ = -1) {
-        Simulator sim(*info, pid, atk_side);
-        sim.task_list[pid] = ops;
+    /**
+     * @brief 模拟评估此行动序列
+     * @param _round 模拟的回合数
+     * @param stopping_f_succ 同Simulator::simulate
+     * @param baseline 若非空且适用于本次模拟，则从其基准轨迹分叉，结果与完整模拟一致
+     * @return const Sim_result& 模拟结果
+     */
+    const Sim_result& evaluate(int _round, int stopping_f_succ = -1, const Defence_baseline* baseline = nullptr) {
+        if (ctx->cache) if (auto hit = ctx->cache->find(ops, atk_side, _round, stopping_f_succ)) {
+            ctx->cache_hits++;
+            return res = *hit;
+        }
+        if (baseline && baseline->covers(atk_side, _round)) return res = baseline->evaluate(ops, _round, stopping_f_succ);
+        Simulator sim(*ctx, *ctx->info, ctx->pid, atk_side);
+        sim.task_list[ctx->pid] = ops;
         res = sim.simulate(_round, stopping_f_succ);
         return res;
     }
@@ -110,6 +123,7 @@ struct Build_cfg {
     bool available; // 是否允许新建
     std::vector<TowerType> lv2_options; // 允许新建的二级塔
     std::vector<TowerType> lv3_options; // 允许新建的三级塔
+    bool rank_by_coverage = false; // 是否按覆盖的路径格数从多到少尝试建塔位置（评估相同时偏向覆盖更多的位置）
 };
 // “升级操作”的配置类
 struct Upgrade_cfg {
@@ -225,6 +239,18 @@ class Op_generator {
             if (cash == -1) cash = info.coins[pid];
         }
 
+        // 建塔位置的尝试顺序
+        std::vector<Pos> build_positions() const {
+            std::vector<Pos> ans = highlands[pid];
+            if (build.rank_by_coverage) {
+                const int range = TOWER_INFO[TowerType::Basic].range;
+                std::stable_sort(ans.begin(), ans.end(), [range](const Pos& a, const Pos& b) {
+                    return path_coverage_size(a.x, a.y, range) > path_coverage_size(b.x, b.y, range);
+                });
+            }
+            return ans;
+        }
+
         bool sell_list_generated = false;
         std::vector<Sell_operation> sell_list;
         // 生成“卖出列表”
@@ -253,7 +279,7 @@ class Op_generator {
 
             // 解决build子问题
             build_list.clear();
-            if (build.available) for (const Pos& p : highlands[pid]) {
+            if (build.available) for (const Pos& p : build_positions()) {
                 if (info.tower_at(p.x, p.y).has_value() || info.is_shielded_by_emp(pid, p.x, p.y)) continue; // 已经建了塔的地方就不必再建了
                 // 1级
                 temp_build.clear();
@@ -382,9 +408,8 @@ class Op_generator {
                 Defense_operation ls;
                 ls.loss = 450, ls.cost = 150;
                 ls.ops.emplace_back(lightning_op({0, 0}));
-                for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
-                    if (!is_valid_pos(x, y)) continue;
-                    ls.ops.back().op = lightning_op({x, y});
+                for (int c : VALID_CELLS) {
+                    ls.ops.back().op = lightning_op({cell_x(c), cell_y(c)});
 
                     // 与Sell部分进行合并，暂时对Sell进行剪枝
                     int first_larger_earn = -1;
@@ -409,9 +434,11 @@ class Op_generator {
                 Defense_operation eva;
                 eva.cost = 100;
                 eva.ops.emplace_back(EVA_op({0, 0}));
-                for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
-                    Pos p{x, y};
-                    if (!is_valid_pos(x, y)) continue;
+                // 只有在我方蚂蚁EVA范围内的点才可能罩住蚂蚁
+                Cell_set reach;
+                for (const Ant& a : info.ants) if (a.player == pid) reach |= super_weapon_area(a.x, a.y, EVA_RANGE);
+                for (int c : reach & VALID_CELLS) {
+                    Pos p{cell_x(c), cell_y(c)};
 
                     // 检查ant是否重复
                     std::vector<int> curr(EVA_ant(p, pid));
@@ -441,10 +468,12 @@ class Op_generator {
                 Defense_operation emp;
                 emp.cost = 150;
                 emp.ops.emplace_back(EMP_op({0, 0}));
-                for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
-                    Pos p{x, y};
+                // 只有在对方塔EMP范围内的点才能屏蔽到塔
+                Cell_set reach;
+                for (const Tower& t : info.towers) if (t.player == !pid) reach |= super_weapon_area(t.x, t.y, EMP_RANGE);
+                for (int c : reach & VALID_CELLS) {
+                    Pos p{cell_x(c), cell_y(c)};
                     int banned_money = EMP_banned_money(p, !pid);
-                    if (!is_valid_pos(x, y) || !banned_money) continue;
 
                     // 刷新准备生成的EMP动作
                     emp.ops.back().op = EMP_op(p);
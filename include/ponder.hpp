@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "operation.hpp"
+#include "baseline.hpp"
+#include "sim_cache.hpp"
+
+/**
+ * 对手决策期间的后台预搜索
+ *
+ * 我方发出操作后，自预测的下一次决策局面（假设对方不操作）起，在后台线程中依次完整评估下一次决策
+ * 大概率会用到的动作序列：不操作（双边及单边）、（拆除+）建塔/升级的各候选，结果存入Sim_cache。
+ * 下一次决策开始时停止后台线程（进行中的模拟在下一回合前停止，其结果不入缓存）；若实际局面与预测一致，则评估时直接取用缓存，否则丢弃。
+ */
+class Ponder {
+    public:
+    Ponder() = default;
+    Ponder(const Ponder&) = delete;
+    Ponder& operator=(const Ponder&) = delete;
+    ~Ponder() { stop(); }
+
+    /**
+     * @brief 开始后台预搜索
+     * @param predicted 预测的本回合结算后的局面
+     * @param pid 我方的玩家编号
+     * @param round 下一次决策的模拟回合数
+     */
+    void start(const GameInfo& predicted, int pid, int round) {
+        stop();
+        info = predicted;
+        for (int p = 0; p < pid; p++) info.count_down_super_weapons_left_time(p); // 推进到我方下一次决策（假设先手方不操作）
+        cache.reset(info, pid);
+        stopping = false;
+        worker = std::thread([this, pid, round] { run(pid, round); });
+    }
+
+    /**
+     * @brief 停止后台预搜索
+     * @param actual 实际的决策局面
+     * @param pid 我方的玩家编号
+     * @return const Sim_cache* 与actual一致时为预搜索的结果，否则为nullptr
+     */
+    const Sim_cache* finish(const GameInfo& actual, int pid) {
+        stop();
+        if (!cache.size() || !cache.matches(actual, pid)) return nullptr;
+        return &cache;
+    }
+
+    private:
+    GameInfo info{0};
+    Sim_cache cache;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+
+    void stop() {
+        stopping = true;
+        if (worker.joinable()) worker.join();
+    }
+
+    void run(int pid, int round) {
+        Game_context ctx;
+        ctx.pid = pid;
+        ctx.info = &info;
+        ctx.cancel = &stopping; // 每回合模拟前检查，使stop尽快返回
+        auto eval = [&](const std::vector<Task>& ops, int atk_side, const Defence_baseline* baseline = nullptr) {
+            if (stopping || cache.find(ops, atk_side, round, -1)) return;
+            for (const Task& t : ops) if (info.round + t.round >= MAX_ROUND) return; // 同AI_::ai_main，不评估超出对局的序列
+            Operation_list opl(ctx, {}, -1, 0, 0, atk_side);
+            opl.ops = ops;
+            const Sim_result& res = opl.evaluate(round, -1, baseline);
+            if (!stopping) cache.insert(ops, atk_side, round, res); // 被中途取消的模拟提前停止，结果不完整
+        };
+
+        eval({}, -1);
+        if (stopping) return;
+        Defence_baseline baseline(ctx, round);
+        eval({}, !pid);
+
+        // 与AI_::ai_main中建塔/升级搜索的两种配置一致
+        Op_generator aware(info, pid);
+        aware << Sell_cfg{3, 3};
+        aware.generate_operations();
+        for (const Defense_operation& op : aware.ops) eval(op.ops, !pid, &baseline);
+
+        Op_generator peace(info, pid);
+        peace.sell.tweaking = true;
+        peace.generate_operations();
+        for (const Defense_operation& op : peace.ops) eval(op.ops, !pid, &baseline);
+    }
+};
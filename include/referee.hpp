@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+
+#include "simulate.hpp"
+#include "io.hpp"
+
+// 裁判类：以Simulator的规则代码维护权威局面，供本地评测及自对弈使用
+class Referee {
+    public:
+    Simulator sim; // 权威局面及规则代码
+    int kills[2] = {0, 0}; // 双方击杀蚂蚁数
+    bool finished = false;
+    int winner = -1; // 胜者编号，平局或未结束时为-1
+    std::string reason; // 对局结束的原因
+    std::vector<Ant> settled_ants; // 上一次结算后下发给选手的蚂蚁列表
+
+    explicit Referee(unsigned long long seed) : sim(GameInfo(seed), 0) {
+        for (int i = 0; i < 2; i++) sim.info.bases[i].hp = Base::MAX_HP; // Simulator默认使用的并非真实血量
+        sim.settled_ants = &settled_ants;
+    }
+
+    const GameInfo& info() const {
+        return sim.info;
+    }
+
+    /**
+     * @brief 检查并执行某一方在本回合的操作，出现非法操作时判负
+     * @param player 操作方
+     * @param ops 该方提交的操作
+     * @return bool 操作是否全部合法
+     */
+    bool apply_operations(int player, const std::vector<Operation>& ops) {
+        std::vector<Operation>& accepted = sim.operations[player];
+        accepted.clear();
+        Op_validator validator(sim.info, player);
+        for (const Operation& op : ops) {
+            if (!validator.append(op)) {
+                forfeit(player, "invalid operation " + op.str(true));
+                return false;
+            }
+            accepted.push_back(op);
+        }
+        sim.apply_operations_of_player(player);
+        return true;
+    }
+
+    /**
+     * @brief 结算当前回合
+     * @return bool 对局是否仍在进行
+     */
+    bool settle() {
+        if (finished) return false;
+        if (!sim.next_round()) {
+            finish_by_score();
+            return false;
+        }
+        for (int i = 0; i < 2; i++) kills[i] += sim.ants_killed[i];
+
+        bool dead[2] = {sim.info.bases[0].hp <= 0, sim.info.bases[1].hp <= 0};
+        if (dead[0] || dead[1]) {
+            finished = true;
+            winner = dead[0] == dead[1] ? -1 : dead[0];
+            reason = "base destroyed";
+        } else if (sim.info.round >= MAX_ROUND) finish_by_score();
+        return !finished;
+    }
+
+    // 某一方违规（超时、非法操作、进程退出等），对方获胜
+    void forfeit(int player, const std::string& why) {
+        if (finished) return;
+        finished = true;
+        winner = !player;
+        reason = str_wrap("player %d: ", player) + why;
+    }
+
+    // 当前需要下发给选手的回合信息
+    RoundInfo round_info() const {
+        RoundInfo ans;
+        ans.round = sim.info.round;
+        ans.towers.assign(sim.info.towers.begin(), sim.info.towers.end());
+        ans.ants = settled_ants;
+        ans.coin0 = sim.info.coins[0], ans.coin1 = sim.info.coins[1];
+        ans.hp0 = sim.info.bases[0].hp, ans.hp1 = sim.info.bases[1].hp;
+        return ans;
+    }
+
+    private:
+    // 回合数耗尽时依次比较血量、击杀数
+    void finish_by_score() {
+        finished = true;
+        const Base* bases = sim.info.bases;
+        if (bases[0].hp != bases[1].hp) winner = bases[0].hp < bases[1].hp;
+        else if (kills[0] != kills[1]) winner = kills[0] < kills[1];
+        else winner = -1;
+        reason = "round limit";
+    }
+};
+
+/* 裁判一侧的序列化，格式与io.hpp中选手一侧的读取函数对应 */
+
+// 序列化操作列表（发送给对手）
+inline std::string serialize_operations(const std::vector<Operation>& ops) {
+    std::ostringstream out;
+    out << ops.size() << '\n';
+    for (const Operation& op : ops) out << op;
+    return out.str();
+}
+
+// 序列化回合信息（发送给双方）
+inline std::string serialize_round_info(const RoundInfo& info) {
+    std::ostringstream out;
+    out << info.round << '\n' << info.towers.size() << '\n';
+    for (const Tower& t : info.towers)
+        out << t.id << ' ' << t.player << ' ' << t.x << ' ' << t.y << ' ' << t.type << ' ' << t.cd << '\n';
+    out << info.ants.size() << '\n';
+    for (const Ant& a : info.ants)
+        out << a.id << ' ' << a.player << ' ' << a.x << ' ' << a.y << ' ' << a.hp << ' ' << a.level << ' ' << a.age << ' ' << a.state << '\n';
+    out << info.coin0 << ' ' << info.coin1 << '\n' << info.hp0 << ' ' << info.hp1 << '\n';
+    return out.str();
+}
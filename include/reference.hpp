@@ -0,0 +1,556 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "game_info.hpp"
+#include "checker.hpp"
+
+/**
+ * 冻结的参考实现：照规则逐条直接实现的操作检查及回合结算，用于差分测试经过优化的Simulator（见tools/fuzz_sim.cpp）
+ *
+ * 这不是优化前（894e419）代码的拷贝：那时的Simulator依赖GameInfo::is_operation_valid、next_move、
+ * update_pheromone_for_ants及Tower::attack等此后已被就地优化的接口，原样冻结需要连同它们一起复制。
+ * 这里按规则独立重写了这些逻辑，并逐条对照894e419核对过结算顺序、计数器及边界情形（如最后一回合的老死计数）。
+ * 只使用GameInfo的数据字段、地图常量、distance_raw以及Tower/Ant/Base中只读写自身字段的简单接口，
+ * 不使用距离表、覆盖集合、超级武器区域、Op_validator等任何加速结构。
+ * 每方的操作以play检查并执行，双方的play与next_round的先后由调用者按Simulator::step_simulation的两种顺序安排。
+ * 优化Simulator、Tower::attack、GameInfo::next_move及信息素的实现时不应修改本文件；规则本身变化时才同步修改。
+ */
+namespace reference {
+
+    inline int dist(int x0, int y0, int x1, int y1) {
+        return distance_raw(x0, y0, x1, y1);
+    }
+    inline bool on_map(int x, int y) {
+        return x >= 0 && x < MAP_SIZE && y >= 0 && y < MAP_SIZE;
+    }
+    inline bool path_at(int x, int y) {
+        return on_map(x, y) && MAP_PROPERTY[x][y] == PointType::Path;
+    }
+    inline bool highland_at(int player, int x, int y) {
+        return on_map(x, y) && MAP_PROPERTY[x][y] == (player == 0 ? PointType::Player0Highland : PointType::Player1Highland);
+    }
+    inline bool valid_at(int x, int y) {
+        return on_map(x, y) && MAP_PROPERTY[x][y] != PointType::Void;
+    }
+
+    class Simulator {
+        public:
+        GameInfo info;
+        std::vector<Operation> operations[2];
+        // 与Simulator的同名计数器含义相同：[i]为玩家i的对手的蚂蚁，next_old为绝对时间
+        int ants_killed[2] = {0, 0};
+        int old_ants[2] = {0, 0};
+        int next_old[2] = {MAX_ROUND + 1, MAX_ROUND + 1};
+
+        explicit Simulator(const GameInfo& info) : info(info) {}
+
+        /* 操作 */
+
+        Tower* tower_of_id(int id) {
+            for (Tower& t : info.towers) if (t.id == id) return &t;
+            return nullptr;
+        }
+        const Tower* tower_of_id(int id) const {
+            for (const Tower& t : info.towers) if (t.id == id) return &t;
+            return nullptr;
+        }
+        int tower_num(int player) const {
+            int ans = 0;
+            for (const Tower& t : info.towers) ans += t.player == player;
+            return ans;
+        }
+        bool emp_shielded(int player, int x, int y) const {
+            for (const SuperWeapon& w : info.super_weapons)
+                if (w.type == EmpBlaster && w.player != player && dist(x, y, w.x, w.y) <= w.range) return true;
+            return false;
+        }
+
+        // 单个操作本身是否合法（不考虑金钱及同类操作）
+        bool op_valid(int player, const Operation& op) const {
+            switch (op.type) {
+                case BuildTower: {
+                    bool occupied = std::any_of(info.towers.begin(), info.towers.end(), [&](const Tower& t) { return t.x == op.arg0 && t.y == op.arg1; });
+                    return highland_at(player, op.arg0, op.arg1) && !occupied && !emp_shielded(player, op.arg0, op.arg1);
+                }
+                case UpgradeTower: {
+                    const Tower* t = tower_of_id(op.arg0);
+                    return t && t->player == player && t->is_upgrade_type_valid(op.arg1) && !emp_shielded(player, t->x, t->y);
+                }
+                case DowngradeTower: {
+                    const Tower* t = tower_of_id(op.arg0);
+                    return t && t->player == player && !emp_shielded(player, t->x, t->y);
+                }
+                case UseLightningStorm:
+                case UseEmpBlaster:
+                case UseDeflector:
+                case UseEmergencyEvasion:
+                    return valid_at(op.arg0, op.arg1) && info.super_weapon_cd[player][op.type % 10] <= 0;
+                case UpgradeGenerationSpeed:
+                    return info.bases[player].gen_speed_level < 2;
+                case UpgradeGeneratedAnt:
+                    return info.bases[player].ant_level < 2;
+                default:
+                    return false;
+            }
+        }
+
+        // 操作的收入（负数为花费），tower_num为操作前该方的塔数
+        int op_income(int player, const Operation& op, int towers) const {
+            switch (op.type) {
+                case BuildTower:
+                    return -GameInfo::build_tower_cost(towers);
+                case UpgradeTower:
+                    return -GameInfo::upgrade_tower_cost(op.arg1);
+                case DowngradeTower: {
+                    const Tower* t = tower_of_id(op.arg0);
+                    if (t->type == TowerType::Basic) return GameInfo::destroy_tower_income(towers);
+                    return GameInfo::downgrade_tower_income(t->type);
+                }
+                case UseLightningStorm:
+                case UseEmpBlaster:
+                case UseDeflector:
+                case UseEmergencyEvasion:
+                    return -GameInfo::use_super_weapon_cost(op.type % 10);
+                case UpgradeGenerationSpeed:
+                    return -GameInfo::upgrade_base_cost(info.bases[player].gen_speed_level);
+                case UpgradeGeneratedAnt:
+                    return -GameInfo::upgrade_base_cost(info.bases[player].ant_level);
+                default:
+                    return 0;
+            }
+        }
+
+        // 在已添加ops的前提下能否再添加new_op：同类操作不重复，操作本身合法，且全部操作的总花费不超过现有金钱
+        bool can_add(int player, const std::vector<Operation>& ops, const Operation& new_op) const {
+            for (const Operation& op : ops) {
+                switch (new_op.type) {
+                    case BuildTower:
+                        if (op.type == BuildTower && op.arg0 == new_op.arg0 && op.arg1 == new_op.arg1) return false;
+                        break;
+                    case UpgradeTower:
+                    case DowngradeTower:
+                        if ((op.type == UpgradeTower || op.type == DowngradeTower) && op.arg0 == new_op.arg0) return false;
+                        break;
+                    case UpgradeGenerationSpeed:
+                    case UpgradeGeneratedAnt:
+                        if (op.type == UpgradeGenerationSpeed || op.type == UpgradeGeneratedAnt) return false;
+                        break;
+                    default:
+                        if (op.type == new_op.type) return false;
+                }
+            }
+            if (!op_valid(player, new_op)) return false;
+            int towers = tower_num(player), income = 0;
+            std::vector<Operation> all(ops);
+            all.push_back(new_op);
+            for (const Operation& op : all) {
+                income += op_income(player, op, towers);
+                if (op.type == BuildTower) towers++;
+                if (op.type == DowngradeTower && tower_of_id(op.arg0)->type == TowerType::Basic) towers--;
+            }
+            return info.coins[player] + income >= 0;
+        }
+
+        void apply_op(int player, const Operation& op) {
+            info.coins[player] += op_income(player, op, tower_num(player));
+            switch (op.type) {
+                case BuildTower:
+                    info.towers.emplace_back(info.next_tower_id++, player, op.arg0, op.arg1, TowerType::Basic);
+                    break;
+                case UpgradeTower:
+                    tower_of_id(op.arg0)->upgrade(static_cast<TowerType>(op.arg1));
+                    break;
+                case DowngradeTower: {
+                    Tower* t = tower_of_id(op.arg0);
+                    if (t->is_downgrade_valid()) t->downgrade();
+                    else info.towers.erase(t, t + 1);
+                    break;
+                }
+                case UseLightningStorm:
+                case UseEmpBlaster:
+                case UseDeflector:
+                case UseEmergencyEvasion: {
+                    SuperWeapon sw(static_cast<SuperWeaponType>(op.type % 10), player, op.arg0, op.arg1);
+                    if (sw.type == EmergencyEvasion) {
+                        for (Ant& a : info.ants) if (a.player == player && dist(a.x, a.y, sw.x, sw.y) <= sw.range) a.evasion = 2;
+                    } else info.super_weapons.push_back(sw);
+                    info.super_weapon_cd[player][sw.type] = SUPER_WEAPON_INFO[sw.type][2];
+                    break;
+                }
+                case UpgradeGenerationSpeed:
+                    info.bases[player].gen_speed_level++;
+                    break;
+                case UpgradeGeneratedAnt:
+                    info.bases[player].ant_level++;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        /**
+         * @brief 一方的回合：逐个检查ops并保留合法者，倒计时该方的超级武器，再依次执行
+         * @return std::vector<Operation> 被接受的操作
+         */
+        std::vector<Operation> play(int player, const std::vector<Operation>& ops) {
+            operations[player].clear();
+            for (const Operation& op : ops) if (can_add(player, operations[player], op)) operations[player].push_back(op);
+            for (int i = 0; i < (int)info.super_weapons.size(); ) {
+                SuperWeapon& w = info.super_weapons[i];
+                if (w.player == player && --w.left_time <= 0) info.super_weapons.erase(info.super_weapons.begin() + i);
+                else i++;
+            }
+            for (const Operation& op : operations[player]) if (op_valid(player, op)) apply_op(player, op);
+            return operations[player];
+        }
+
+        /* 结算 */
+
+        // 塔的一次攻击，返回受到攻击的蚂蚁下标（升序、不重复）
+        std::vector<int> tower_attack(Tower& tower) {
+            std::vector<int> attacked;
+            tower.cd = std::max(tower.cd - 1, 0);
+            if (tower.cd > 0) return attacked;
+            auto attackable = [&](int cx, int cy, int range) {
+                std::vector<int> idxs;
+                for (int i = 0; i < (int)info.ants.size(); i++) {
+                    const Ant& a = info.ants[i];
+                    if (a.player != tower.player && a.is_alive() && dist(a.x, a.y, cx, cy) <= range) idxs.push_back(i);
+                }
+                return idxs;
+            };
+            int time = tower.speed >= 1 ? 1 : (1 / tower.speed);
+            int target_num = tower.type == Double ? 2 : 1;
+            while (time--) {
+                std::vector<int> targets = attackable(tower.x, tower.y, tower.range);
+                std::stable_sort(targets.begin(), targets.end(), [&](int i, int j) {
+                    return dist(info.ants[i].x, info.ants[i].y, tower.x, tower.y) < dist(info.ants[j].x, info.ants[j].y, tower.x, tower.y);
+                });
+                if ((int)targets.size() > target_num) targets.resize(target_num);
+                std::vector<int> affected;
+                for (int idx : targets) {
+                    std::vector<int> tmp;
+                    const Ant& t = info.ants[idx];
+                    switch (tower.type) {
+                        case Mortar:
+                        case MortarPlus:
+                            tmp = attackable(t.x, t.y, 1);
+                            break;
+                        case Pulse:
+                            tmp = attackable(tower.x, tower.y, tower.range);
+                            break;
+                        case Missile:
+                            tmp = attackable(t.x, t.y, 2);
+                            break;
+                        default:
+                            tmp = {idx};
+                    }
+                    affected.insert(affected.end(), tmp.begin(), tmp.end());
+                }
+                for (int idx : affected) {
+                    Ant& a = info.ants[idx];
+                    if (a.evasion > 0) a.evasion--;
+                    else if (a.deflector && tower.damage < a.max_hp() / 2) continue;
+                    else {
+                        a.hp -= tower.damage;
+                        if (tower.type == Ice) a.state = AntState::Frozen;
+                        if (a.hp <= 0) a.state = AntState::Fail;
+                    }
+                }
+                attacked.insert(attacked.end(), affected.begin(), affected.end());
+            }
+            std::sort(attacked.begin(), attacked.end());
+            attacked.erase(std::unique(attacked.begin(), attacked.end()), attacked.end());
+            if (!attacked.empty()) tower.reset_cd();
+            return attacked;
+        }
+
+        void attack_ants() {
+            for (const SuperWeapon& w : info.super_weapons) {
+                if (w.type != LightningStorm) continue;
+                for (Ant& a : info.ants) if (a.player != w.player && dist(a.x, a.y, w.x, w.y) <= w.range) {
+                    a.hp = 0;
+                    a.state = AntState::Fail;
+                    info.coins[w.player] += a.reward();
+                }
+            }
+            for (Ant& a : info.ants) {
+                a.deflector = false;
+                for (const SuperWeapon& w : info.super_weapons)
+                    if (w.type == Deflector && w.player == a.player && dist(a.x, a.y, w.x, w.y) <= w.range) a.deflector = true;
+            }
+            for (Tower& t : info.towers) {
+                if (emp_shielded(t.player, t.x, t.y)) continue;
+                for (int idx : tower_attack(t)) if (info.ants[idx].state == AntState::Fail) info.coins[t.player] += info.ants[idx].reward();
+                t.damage = TOWER_INFO[t.type].attack;
+            }
+            for (Ant& a : info.ants) a.deflector = false;
+        }
+
+        // 蚂蚁的移动方向：不回头的路径邻格中，按“距离加权的信息素、原始信息素、方向编号”选择
+        int next_move(const Ant& a) const {
+            static constexpr double ETA[] = {1.25, 1.00, 0.75};
+            int tx = Base::POSITION[!a.player][0], ty = Base::POSITION[!a.player][1];
+            int cur = dist(a.x, a.y, tx, ty);
+            int best = 0;
+            double best_w = -1, best_o = -1;
+            for (int i = 0; i < 6; i++) {
+                int x = a.x + OFFSET[a.y % 2][i][0], y = a.y + OFFSET[a.y % 2][i][1];
+                double w = -1, o = -1;
+                if (!(a.path.size() && a.path.back() == (i + 3) % 6) && path_at(x, y)) {
+                    o = info.pheromone[a.player][x][y];
+                    w = ETA[dist(x, y, tx, ty) - cur + 1] * o;
+                }
+                if (w > best_w || (w == best_w && o > best_o)) {
+                    best = i;
+                    best_w = w;
+                    best_o = o;
+                }
+            }
+            return best;
+        }
+
+        void move_ants() {
+            for (Ant& a : info.ants) {
+                a.age++;
+                if (a.state == AntState::Fail) continue;
+                if (a.age > Ant::AGE_LIMIT) a.state = AntState::TooOld;
+                if (a.state == AntState::Alive) a.move(next_move(a));
+                if (a.x == Base::POSITION[!a.player][0] && a.y == Base::POSITION[!a.player][1]) {
+                    a.state = AntState::Success;
+                    info.bases[!a.player].hp--;
+                    info.coins[a.player] += 5;
+                }
+                if (a.state == AntState::Frozen) a.state = AntState::Alive;
+            }
+        }
+
+        void update_pheromone() {
+            for (int p = 0; p < 2; p++) for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++)
+                info.pheromone[p][x][y] = PHEROMONE_ATTENUATING_RATIO * info.pheromone[p][x][y] + (1 - PHEROMONE_ATTENUATING_RATIO) * PHEROMONE_INIT;
+            static constexpr double TAU[] = {0.0, 10.0, -5, -3};
+            for (const Ant& a : info.ants) {
+                if (a.is_alive()) continue;
+                std::vector<std::pair<int, int>> cells{{Base::POSITION[a.player][0], Base::POSITION[a.player][1]}};
+                for (int move : a.path) {
+                    auto [x, y] = cells.back();
+                    cells.push_back({x + OFFSET[y % 2][move][0], y + OFFSET[y % 2][move][1]});
+                }
+                std::sort(cells.begin(), cells.end());
+                cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+                for (auto [x, y] : cells) {
+                    double& ph = info.pheromone[a.player][x][y];
+                    ph += int(TAU[a.state]);
+                    if (ph < PHEROMONE_MIN) ph = PHEROMONE_MIN;
+                }
+            }
+        }
+
+        // 结算一回合，返回对局是否仍在进行
+        bool next_round() {
+            if (info.round == MAX_ROUND) return false;
+            attack_ants();
+            move_ants();
+            update_pheromone();
+            for (int i = 0; i < 2; i++) {
+                int killed = 0, old = 0;
+                for (const Ant& a : info.ants) if (a.player == i) {
+                    killed += a.state == AntState::Fail;
+                    old += a.state == AntState::TooOld;
+                }
+                ants_killed[!i] = killed; // 只计本回合
+                if (old && next_old[!i] > MAX_ROUND) next_old[!i] = info.round;
+                old_ants[!i] += old;
+            }
+            for (int i = 0; i < (int)info.ants.size(); ) {
+                AntState s = info.ants[i].state;
+                if (s == AntState::Success || s == AntState::Fail || s == AntState::TooOld) info.ants.erase(info.ants.begin() + i);
+                else i++;
+            }
+            for (Base& b : info.bases) {
+                if (info.round % Base::GENERATION_CYCLE_INFO[b.gen_speed_level]) continue;
+                info.ants.push_back(Ant(info.next_ant_id++, b.player, b.x, b.y, Ant::MAX_HP_INFO[b.ant_level], b.ant_level, 0, AntState::Alive));
+            }
+            if (info.round == MAX_ROUND - 1) for (const Ant& a : info.ants) { // 对局结束时仍存活的蚂蚁（含刚生成的）也计为老死
+                next_old[!a.player] = info.round;
+                old_ants[!a.player]++;
+            }
+            info.coins[0] += BASIC_INCOME;
+            info.coins[1] += BASIC_INCOME;
+            info.round++;
+            for (int i = 0; i < 2; i++) for (int j = 1; j < SuperWeaponCount; j++)
+                info.super_weapon_cd[i][j] = std::max(info.super_weapon_cd[i][j] - 1, 0);
+            return true;
+        }
+    };
+
+    /**
+     * @brief 逐字段比对两个局面的全部内容（含基地、信息素、超级武器剩余时间、蚂蚁路径）
+     * @return std::string 差异报告，每条差异占一行，无差异时为空
+     */
+    inline std::string full_diff(const GameInfo& a, const GameInfo& b) {
+        std::string ans = state_diff(a, b);
+        auto field = [&](const char* name, long long x, long long y) {
+            if (x != y) ans += str_wrap("%s %lld->%lld\n", name, x, y);
+        };
+        field("round", a.round, b.round);
+        field("next_ant_id", a.next_ant_id, b.next_ant_id);
+        field("next_tower_id", a.next_tower_id, b.next_tower_id);
+        for (int i = 0; i < 2; i++) {
+            field(i ? "base1.hp" : "base0.hp", a.bases[i].hp, b.bases[i].hp);
+            field(i ? "base1.gen_speed_level" : "base0.gen_speed_level", a.bases[i].gen_speed_level, b.bases[i].gen_speed_level);
+            field(i ? "base1.ant_level" : "base0.ant_level", a.bases[i].ant_level, b.bases[i].ant_level);
+        }
+        if (a.ants.size() == b.ants.size())
+            for (int i = 0; i < (int)a.ants.size(); i++)
+                if (a.ants[i].id == b.ants[i].id && (a.ants[i].deflector != b.ants[i].deflector
+                    || !std::equal(a.ants[i].path.begin(), a.ants[i].path.end(), b.ants[i].path.begin(), b.ants[i].path.end())))
+                    ans += str_wrap("ant %d: path or deflector differs\n", a.ants[i].id);
+        field("super_weapons", a.super_weapons.size(), b.super_weapons.size());
+        for (int i = 0; i < (int)std::min(a.super_weapons.size(), b.super_weapons.size()); i++) {
+            const SuperWeapon &x = a.super_weapons[i], &y = b.super_weapons[i];
+            if (x.type != y.type || x.player != y.player || x.x != y.x || x.y != y.y || x.left_time != y.left_time)
+                ans += str_wrap("super weapon %d: type%d p%d (%d,%d) left%d -> type%d p%d (%d,%d) left%d\n", i,
+                    x.type, x.player, x.x, x.y, x.left_time, y.type, y.player, y.x, y.y, y.left_time);
+        }
+        for (int p = 0; p < 2; p++) for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++)
+            if (a.pheromone[p][x][y] != b.pheromone[p][x][y])
+                ans += str_wrap("pheromone[%d][%d][%d] %.17g->%.17g\n", p, x, y, a.pheromone[p][x][y], b.pheromone[p][x][y]);
+        return ans;
+    }
+
+    /**
+     * 随机局面生成：双方在各自高地上的塔（随机类型及冷却）、沿路径从己方基地出发不回头游走得到的蚂蚁
+     * （路径与位置一致）、生效中的超级武器、冷却、金钱、基地等级及扰动后的信息素；部分局面接近终局，以覆盖最后一回合的结算
+     */
+    class State_generator {
+        public:
+        explicit State_generator(uint64_t seed) : rng(seed) {}
+
+        GameInfo generate() {
+            GameInfo info(rng());
+            info.round = chance(0.2) ? uniform(MAX_ROUND - 30, MAX_ROUND - 1) : uniform(0, MAX_ROUND - 40); // 部分局面接近终局
+            for (int p = 0; p < 2; p++) {
+                info.coins[p] = uniform(0, 400);
+                info.bases[p].gen_speed_level = uniform(0, 2);
+                info.bases[p].ant_level = uniform(0, 2);
+                info.bases[p].hp = uniform(1, 50);
+                for (int j = 1; j < SuperWeaponCount; j++) info.super_weapon_cd[p][j] = chance(0.6) ? 0 : uniform(1, SUPER_WEAPON_INFO[j][2]);
+            }
+
+            // 塔
+            std::vector<std::pair<int, int>> highland[2];
+            for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) for (int p = 0; p < 2; p++)
+                if (highland_at(p, x, y)) highland[p].push_back({x, y});
+            for (int p = 0; p < 2; p++) {
+                std::shuffle(highland[p].begin(), highland[p].end(), rng);
+                int n = uniform(0, MAX_TOWER_NUM / 2 - 2);
+                for (int i = 0; i < n; i++) {
+                    auto [x, y] = highland[p][i];
+                    Tower& t = info.towers.emplace_back(info.next_tower_id++, p, x, y, TOWER_TYPES[uniform(0, std::size(TOWER_TYPES) - 1)]);
+                    t.cd = uniform(0, std::max(1, int(t.speed)));
+                }
+            }
+            std::shuffle(info.towers.begin(), info.towers.end(), rng);
+
+            // 蚂蚁：每方每个年龄至多一只，与实际对局中蚂蚁数的上界一致
+            for (int p = 0; p < 2; p++) for (int age = Ant::AGE_LIMIT; age >= 0; age--) {
+                if (!chance(0.4)) continue;
+                int level = uniform(0, 2);
+                Ant a(info.next_ant_id++, p, Base::POSITION[p][0], Base::POSITION[p][1], uniform(1, Ant::MAX_HP_INFO[level]), level, 0, AntState::Alive);
+                for (; a.age < age; a.age++) {
+                    std::vector<int> dirs;
+                    for (int d = 0; d < 6; d++) {
+                        int x = a.x + OFFSET[a.y % 2][d][0], y = a.y + OFFSET[a.y % 2][d][1];
+                        if (path_at(x, y) && !(a.path.size() && a.path.back() == (d + 3) % 6)) dirs.push_back(d);
+                    }
+                    if (dirs.empty() || chance(0.2)) continue; // 被冰冻过而停留
+                    a.move(dirs[uniform(0, dirs.size() - 1)]);
+                    if (a.x == Base::POSITION[!p][0] && a.y == Base::POSITION[!p][1]) break;
+                }
+                if (a.x == Base::POSITION[!p][0] && a.y == Base::POSITION[!p][1]) continue;
+                if (chance(0.1)) a.evasion = uniform(1, 2);
+                info.ants.push_back(a);
+            }
+
+            // 超级武器（每方每种至多一个）
+            for (int p = 0; p < 2; p++) for (int type = LightningStorm; type < EmergencyEvasion; type++) {
+                if (!chance(0.25)) continue;
+                int x, y;
+                do {
+                    x = uniform(0, MAP_SIZE - 1);
+                    y = uniform(0, MAP_SIZE - 1);
+                } while (!valid_at(x, y));
+                SuperWeapon& w = info.super_weapons.emplace_back(static_cast<SuperWeaponType>(type), p, x, y);
+                int age = uniform(1, SUPER_WEAPON_INFO[type][0]); // 已使用的回合数，冷却与之一致，因此不会再次使用同类武器
+                w.left_time = SUPER_WEAPON_INFO[type][0] - age + 1;
+                info.super_weapon_cd[p][type] = SUPER_WEAPON_INFO[type][2] - age;
+            }
+            info.update_super_weapon_areas();
+
+            // 信息素：在初始值附近扰动，并在部分格点上取整以制造相等的情形
+            for (int p = 0; p < 2; p++) for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++) {
+                double& ph = info.pheromone[p][x][y];
+                if (chance(0.3)) ph = uniform(0, 20);
+                else if (chance(0.5)) ph += std::uniform_real_distribution<double>(-5, 5)(rng);
+                if (ph < PHEROMONE_MIN) ph = PHEROMONE_MIN;
+            }
+            return info;
+        }
+
+        /**
+         * @brief 生成一方在一回合内尝试的操作，多数合法，也包含非法及重复的操作
+         */
+        std::vector<Operation> operations(const GameInfo& info, int player) {
+            std::vector<Operation> ops;
+            int n = chance(0.5) ? 0 : uniform(1, 4);
+            int towers = std::count_if(info.towers.begin(), info.towers.end(), [&](const Tower& t) { return t.player == player; });
+            for (int i = 0; i < n; i++) {
+                switch (uniform(0, 5)) {
+                    case 0: {
+                        if (++towers > MAX_TOWER_NUM / 2) break; // 不超出塔数的上限
+                        int x, y;
+                        do {
+                            x = uniform(0, MAP_SIZE - 1);
+                            y = uniform(0, MAP_SIZE - 1);
+                        } while (!chance(0.1) && !highland_at(player, x, y));
+                        ops.emplace_back(BuildTower, x, y);
+                        break;
+                    }
+                    case 1:
+                    case 2: {
+                        int id = info.towers.size() && !chance(0.1) ? info.towers[uniform(0, info.towers.size() - 1)].id : uniform(0, info.next_tower_id + 1);
+                        if (chance(0.5)) ops.emplace_back(DowngradeTower, id);
+                        else ops.emplace_back(UpgradeTower, id, TOWER_TYPES[uniform(0, std::size(TOWER_TYPES) - 1)]);
+                        break;
+                    }
+                    case 3:
+                    case 4: {
+                        static constexpr OperationType WEAPONS[] = {UseLightningStorm, UseEmpBlaster, UseDeflector, UseEmergencyEvasion};
+                        ops.emplace_back(WEAPONS[uniform(0, 3)], uniform(0, MAP_SIZE - 1), uniform(0, MAP_SIZE - 1));
+                        break;
+                    }
+                    default:
+                        ops.emplace_back(chance(0.5) ? UpgradeGenerationSpeed : UpgradeGeneratedAnt);
+                }
+            }
+            return ops;
+        }
+
+        private:
+        static constexpr TowerType TOWER_TYPES[] = {Basic, Heavy, HeavyPlus, Ice, Cannon, Quick, QuickPlus, Double, Sniper, Mortar, MortarPlus, Pulse, Missile};
+        std::mt19937_64 rng;
+
+        int uniform(int lo, int hi) {
+            return std::uniform_int_distribution<int>(lo, hi)(rng);
+        }
+        bool chance(double p) {
+            return std::bernoulli_distribution(p)(rng);
+        }
+    };
+}
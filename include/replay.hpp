@@ -0,0 +1,216 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <optional>
+
+#include "json.hpp"
+#include "io.hpp"
+
+/**
+ * 回放文件的读取
+ *
+ * 回放格式以py_script/script.py下载到downloads/replay/下的*.json的saiblo回放为准：
+ * @verbatim
+ * {
+ *   "seed": 信息素初始化的随机种子（可选，saiblo回放中没有，此时初始信息素未知）,
+ *   "replay": [ // 第i项记录第i回合
+ *     {
+ *       "op0": [{"type": 11, "arg0": 5, "arg1": 9}, ...], // 也接受"args": [5, 9]的写法
+ *       "op1": [...],
+ *       "round_state": { // 第i回合结算后（即下发给选手的）局面
+ *         "round": i + 1,
+ *         "towers": [{"id", "player", "x", "y", "type", "cd"}, ...], // 坐标也接受"pos": {"x", "y"}
+ *         "ants": [{"id", "player", "x", "y", "hp", "level", "age", "state"}, ...], // "state"也可写作"status"
+ *         "coins": [coin0, coin1],
+ *         "camps": [hp0, hp1],
+ *         "pheromone": [[[...]]] // 可选，pheromone[player][x][y]
+ *       }
+ *     }, ...
+ *   ]
+ * }
+ * @endverbatim
+ * 顶层直接为回合数组的文件同样可以读取
+ */
+
+// 回放中的一个回合
+struct Replay_round {
+    std::vector<Operation> ops[2]; // 双方在该回合的操作
+    RoundInfo state; // 该回合结算后的局面
+    bool has_pheromone = false;
+    double pheromone[2][MAP_SIZE][MAP_SIZE];
+};
+
+// 一局完整的回放
+struct Replay {
+    std::string name;
+    bool has_seed = false; // 回放是否记录了种子，否则seed无意义
+    unsigned long long seed = 0;
+    std::vector<Replay_round> rounds;
+};
+
+namespace replay_detail {
+    inline int pos_field(const Json& j, const char* key) {
+        if (const Json* pos = j.find("pos")) return (*pos)[key].as_int();
+        return j[key].as_int();
+    }
+    inline std::vector<Operation> read_ops(const Json& j) {
+        std::vector<Operation> ops;
+        for (const Json& op : j.arr) {
+            OperationType type = static_cast<OperationType>(op["type"].as_int());
+            int arg0 = Operation::INVALID_ARG, arg1 = Operation::INVALID_ARG;
+            if (const Json* args = op.find("args")) {
+                arg0 = args->at(0).as_int(Operation::INVALID_ARG);
+                arg1 = args->at(1).as_int(Operation::INVALID_ARG);
+            } else {
+                arg0 = op["arg0"].as_int(Operation::INVALID_ARG);
+                arg1 = op["arg1"].as_int(Operation::INVALID_ARG);
+            }
+            ops.emplace_back(type, arg0, arg1);
+        }
+        return ops;
+    }
+    inline void read_state(const Json& j, int default_round, Replay_round& out) {
+        RoundInfo& s = out.state;
+        s.round = j["round"].as_int(default_round);
+        for (const Json& t : j["towers"].arr) {
+            s.towers.emplace_back(t["id"].as_int(), t["player"].as_int(), pos_field(t, "x"), pos_field(t, "y"),
+                static_cast<TowerType>(t["type"].as_int()));
+            s.towers.back().cd = t["cd"].as_int(); // Tower的构造函数会重置cd，这里以回放为准
+        }
+        for (const Json& a : j["ants"].arr) {
+            const Json* state = a.find("state");
+            if (!state) state = a.find("status");
+            s.ants.emplace_back(a["id"].as_int(), a["player"].as_int(), pos_field(a, "x"), pos_field(a, "y"),
+                a["hp"].as_int(), a["level"].as_int(), a["age"].as_int(), static_cast<AntState>(state ? state->as_int() : 0));
+        }
+        s.coin0 = j["coins"].at(0).as_int();
+        s.coin1 = j["coins"].at(1).as_int();
+        s.hp0 = j["camps"].at(0).as_int();
+        s.hp1 = j["camps"].at(1).as_int();
+
+        const Json& phero = j["pheromone"];
+        out.has_pheromone = phero.is_array() && phero.size() == 2;
+        for (int i = 0; i < 2 && out.has_pheromone; i++) for (int x = 0; x < MAP_SIZE; x++) for (int y = 0; y < MAP_SIZE; y++)
+            out.pheromone[i][x][y] = phero.at(i).at(x).at(y).as_double();
+    }
+}
+
+/**
+ * @brief 从文件中读取一局回放
+ * @param path 回放文件路径
+ * @param err 读取失败时的错误信息
+ * @return std::optional<Replay> 读取结果，失败时为nullopt
+ */
+inline std::optional<Replay> load_replay(const std::string& path, std::string& err) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) {
+        err = "cannot open " + path;
+        return std::nullopt;
+    }
+    std::stringstream buffer;
+    buffer << fin.rdbuf();
+
+    bool ok;
+    Json root = Json::parse(buffer.str(), ok);
+    if (!ok) {
+        err = "malformed json in " + path;
+        return std::nullopt;
+    }
+
+    const Json& rounds = root.is_array() ? root : root["replay"];
+    if (!rounds.is_array()) {
+        err = "no replay array in " + path;
+        return std::nullopt;
+    }
+
+    Replay rep;
+    rep.name = path;
+    if (const Json* seed = root.is_object() ? root.find("seed") : nullptr) {
+        rep.has_seed = true;
+        rep.seed = seed->as_ull();
+    }
+    rep.rounds.resize(rounds.size());
+    for (size_t i = 0; i < rounds.size(); i++) {
+        const Json& r = rounds.at(i);
+        rep.rounds[i].ops[0] = replay_detail::read_ops(r["op0"]);
+        rep.rounds[i].ops[1] = replay_detail::read_ops(r["op1"]);
+        replay_detail::read_state(r["round_state"], i + 1, rep.rounds[i]);
+    }
+    return rep;
+}
+
+// 回放写入器，写出的格式可被load_replay读取
+class Replay_writer {
+    public:
+    explicit Replay_writer(unsigned long long seed) : seed(seed) {}
+
+    /**
+     * @brief 记录一个回合
+     * @param ops 双方在该回合的操作
+     * @param state 该回合结算后下发的局面
+     * @param pheromone 若非空，则同时记录结算后的信息素
+     */
+    void add_round(const std::vector<Operation> ops[2], const RoundInfo& state, const double (*pheromone)[MAP_SIZE][MAP_SIZE] = nullptr) {
+        std::ostringstream out;
+        out << (rounds.empty() ? "\n{" : ",\n{");
+        for (int p = 0; p < 2; p++) {
+            out << "\"op" << p << "\":[";
+            for (size_t i = 0; i < ops[p].size(); i++) {
+                const Operation& op = ops[p][i];
+                out << (i ? "," : "") << "{\"type\":" << op.type << ",\"arg0\":" << op.arg0 << ",\"arg1\":" << op.arg1 << '}';
+            }
+            out << "],";
+        }
+        out << "\"round_state\":{\"round\":" << state.round << ",\"towers\":[";
+        for (size_t i = 0; i < state.towers.size(); i++) {
+            const Tower& t = state.towers[i];
+            out << (i ? "," : "") << "{\"id\":" << t.id << ",\"player\":" << t.player << ",\"x\":" << t.x << ",\"y\":" << t.y
+                << ",\"type\":" << t.type << ",\"cd\":" << t.cd << '}';
+        }
+        out << "],\"ants\":[";
+        for (size_t i = 0; i < state.ants.size(); i++) {
+            const Ant& a = state.ants[i];
+            out << (i ? "," : "") << "{\"id\":" << a.id << ",\"player\":" << a.player << ",\"x\":" << a.x << ",\"y\":" << a.y
+                << ",\"hp\":" << a.hp << ",\"level\":" << a.level << ",\"age\":" << a.age << ",\"state\":" << a.state << '}';
+        }
+        out << "],\"coins\":[" << state.coin0 << ',' << state.coin1 << "],\"camps\":[" << state.hp0 << ',' << state.hp1 << ']';
+        if (pheromone) {
+            out << ",\"pheromone\":[";
+            out.precision(17);
+            for (int p = 0; p < 2; p++) for (int x = 0; x < MAP_SIZE; x++) {
+                out << (x ? "," : p ? ",[" : "[") << '[';
+                for (int y = 0; y < MAP_SIZE; y++) out << (y ? "," : "") << pheromone[p][x][y];
+                out << ']' << (x == MAP_SIZE - 1 ? "]" : "");
+            }
+            out << ']';
+        }
+        out << "}}";
+        rounds += out.str();
+    }
+
+    /**
+     * @brief 将回放写入文件
+     * @param path 文件路径
+     * @param winner 胜者编号，平局为-1
+     * @param reason 对局结束的原因
+     * @return bool 是否写入成功
+     */
+    bool save(const std::string& path, int winner, const std::string& reason) const {
+        std::ofstream fout(path, std::ios::binary);
+        if (!fout) return false;
+        std::string escaped;
+        for (char ch : reason) {
+            if (ch == '"' || ch == '\\') escaped.push_back('\\');
+            escaped.push_back(ch);
+        }
+        fout << "{\"seed\":" << seed << ",\"winner\":" << winner << ",\"reason\":\"" << escaped << "\",\"replay\":[" << rounds << "\n]}\n";
+        return bool(fout);
+    }
+
+    private:
+    unsigned long long seed;
+    std::string rounds;
+};
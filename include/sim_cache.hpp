@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "simulate.hpp"
+#include "checker.hpp"
+
+/**
+ * 预先算好的动作序列评估结果，只适用于一个确定的局面
+ *
+ * 保存的均为不提前停止的完整模拟结果。以stopping_f_succ评估时，只要完整结果的first_succ不小于stopping_f_succ，
+ * 模拟就不会提前停止，结果与完整结果一致；否则无法由完整结果得出，视为未命中。
+ */
+class Sim_cache {
+    public:
+    /**
+     * @brief 局面的标识，包含影响模拟的全部字段（基地血量除外，Simulator总会将其重置）
+     * @param info 给定的局面
+     * @param pid 模拟的立场
+     * @return uint64_t 标识
+     */
+    static uint64_t position_key(const GameInfo& info, int pid) {
+        using checker_detail::mix;
+        using checker_detail::pack;
+        uint64_t h = mix(state_hash(info), pack(info.round, pid));
+        h = mix(h, pack(info.next_ant_id, info.next_tower_id));
+        h = mix(h, info.seed);
+        for (const Base& b : info.bases) h = mix(h, pack(b.gen_speed_level, b.ant_level));
+        for (const SuperWeapon& s : info.super_weapons) {
+            h = mix(h, pack(s.type, s.player));
+            h = mix(h, pack(s.x, s.y));
+            h = mix(h, s.left_time);
+        }
+        const uint64_t* ph = reinterpret_cast<const uint64_t*>(info.pheromone);
+        for (size_t i = 0; i < sizeof(info.pheromone) / sizeof(uint64_t); i++) h = mix(h, ph[i]);
+        return h;
+    }
+
+    // 清空并改为适用于给定局面
+    void reset(const GameInfo& info, int pid) {
+        key = position_key(info, pid);
+        entries.clear();
+    }
+    bool matches(const GameInfo& info, int pid) const {
+        return key == position_key(info, pid);
+    }
+    size_t size() const { return entries.size(); }
+
+    /**
+     * @brief 记录一个完整模拟结果
+     * @param ops 我方的动作序列（相对时间）
+     * @param atk_side 同Simulator的atk_side
+     * @param round 模拟的回合数
+     * @param res 不提前停止的模拟结果
+     */
+    void insert(const std::vector<Task>& ops, int atk_side, int round, const Sim_result& res) {
+        entries.emplace(entry_key(ops, atk_side, round), Entry{ops, atk_side, round, res});
+    }
+
+    // 查找与Simulator::simulate(round, stopping_f_succ)一致的结果
+    std::optional<Sim_result> find(const std::vector<Task>& ops, int atk_side, int round, int stopping_f_succ) const {
+        auto it = entries.find(entry_key(ops, atk_side, round));
+        if (it == entries.end()) return std::nullopt;
+        const Entry& e = it->second;
+        if (e.atk_side != atk_side || e.round != round || !same_ops(e.ops, ops)) return std::nullopt;
+        if (e.res.first_succ < stopping_f_succ) return std::nullopt;
+        return e.res;
+    }
+
+    private:
+    struct Entry {
+        std::vector<Task> ops;
+        int atk_side, round;
+        Sim_result res;
+    };
+
+    uint64_t key = 0;
+    std::unordered_map<uint64_t, Entry> entries;
+
+    static uint64_t entry_key(const std::vector<Task>& ops, int atk_side, int round) {
+        using checker_detail::mix;
+        using checker_detail::pack;
+        uint64_t h = mix(ops.size(), pack(atk_side, round));
+        for (const Task& t : ops) {
+            h = mix(h, pack(t.round, t.op.type));
+            h = mix(h, pack(t.op.arg0, t.op.arg1));
+        }
+        return h;
+    }
+    static bool same_ops(const std::vector<Task>& a, const std::vector<Task>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Task& x, const Task& y) {
+            return x.round == y.round && x.op.type == y.op.type && x.op.arg0 == y.op.arg0 && x.op.arg1 == y.op.arg1;
+        });
+    }
+};
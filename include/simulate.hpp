@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "game_info.hpp"
 
 // 模拟结果类
@@ -23,11 +25,25 @@ struct Sim_result {
         old_ant(99), next_old(0), dmg_dealt(0), dmg_time(MAX_ROUND + 1), old_opp(0), next_old_opp(MAX_ROUND + 1), early_stop(false) {}
 };
 
+class Sim_cache;
+
+// 一局对局中某一方AI的决策上下文，代替原先的全局变量，使多局对局可在同一进程内并行
+struct Game_context {
+    int pid = 0; // 当前决策的玩家编号
+    const GameInfo* info = nullptr; // 当前决策所基于的局面
+    int sim_count = 0; // 累计构造的Simulator数
+    int round_count = 0; // Simulator累计模拟的回合数，用于控制搜索耗时
+    const Sim_cache* cache = nullptr; // 若非空，评估动作序列时先查找其中预先算好的结果（见ponder.hpp）
+    int cache_hits = 0; // 累计命中cache的评估数
+    const std::atomic<bool>* cancel = nullptr; // 若非空且被置位，则进行中的模拟在下一回合前提前停止，其结果应丢弃（见ponder.hpp）
+
+    bool cancelled() const { return cancel && cancel->load(std::memory_order_relaxed); }
+};
+
 // 模拟器类
 class Simulator {
 public:
-    static int sim_count;
-    static int round_count;
+    Game_context* ctx = nullptr; // 若非空，则在其中累计模拟的开销
 
     const int pid;
     GameInfo info;                          // Game state
@@ -35,9 +51,14 @@ public:
     std::vector<Task> task_list[2];
 
     bool verbose = 0;
+    std::vector<Ant>* settled_ants = nullptr; // 若非空，则记录每回合结算后、清理前的全部蚂蚁及新生成的蚂蚁（即judger下发的蚂蚁列表）
     int ants_killed[2] = {0, 0};
     int old_ants[2] = {0, 0};
     int next_old[2] = {MAX_ROUND + 1, MAX_ROUND + 1}; // 这是绝对时间
+    // 若非空，则apply_operations_of_player及next_round在修改前将局面及上述计数器中被修改的部分记录于此，
+    // 可以mark后推进若干（半）回合再rollback，从而在同一个Simulator上尝试多种后续而不复制局面。
+    // 日志记录的是对象地址，复制Simulator后副本应另设日志或置空
+    Undo_log* undo = nullptr;
 
     static constexpr int INIT_HEALTH = 49;
     /**
@@ -47,10 +68,17 @@ public:
      * @param atk_side 本次模拟所关注的“进攻方”，只有进攻方的蚂蚁以及“防守方”的塔会被模拟。默认为两方都模拟
      */
     explicit Simulator(const GameInfo& curr_info, int pid, int atk_side = -1) : info(curr_info), pid(pid) {
-        sim_count++;
         for (int i = 0; i < 2; i++) info.bases[i].hp = INIT_HEALTH;
         if (atk_side != -1) set_side(atk_side);
     }
+    /**
+     * @brief 构造一个新的Simulator对象，并在给定的上下文中累计模拟开销
+     * @param ctx 决策上下文
+     */
+    Simulator(Game_context& ctx, const GameInfo& curr_info, int pid, int atk_side = -1) : Simulator(curr_info, pid, atk_side) {
+        this->ctx = &ctx;
+        ctx.sim_count++;
+    }
 
     /**
      * @brief 进入“单边模拟模式”并设置“进攻方”，在“单边模拟模式”中，只有进攻方的蚂蚁以及“防守方”的塔会被模拟
@@ -103,40 +131,79 @@ public:
             }
         }
     }
+    /**
+     * @brief 模拟round回合并统计结果
+     * @param round 模拟的回合数
+     * @param stopping_f_succ 我方第一次掉血早于此回合（相对时间）时提前停止
+     * @return Sim_result 模拟结果
+     */
     Sim_result simulate(int round, int stopping_f_succ) {
-        int start_round = info.round;
+        start_simulation();
+        continue_simulation(round, stopping_f_succ);
+        return simulation_result();
+    }
 
+    // 模拟进度。simulate可以拆分为start_simulation、若干次continue_simulation及simulation_result，
+    // 并可在任意两次continue_simulation之间复制整个Simulator作为检查点
+    struct Progress {
+        int start_round = 0; // 开始模拟时的回合数
+        int done = 0; // 已模拟的回合数
         Sim_result res;
-        res.first_succ = res.dmg_time = res.first_enc = res.next_old = MAX_ROUND + 1;
-
         std::vector<int> enc_ant_id;
-        for (int i = 0; i < 2; i++) std::sort(task_list[i].begin(), task_list[i].end(), __cmp_downgrade_last); // 将降级操作排到最后(因为操作从最后开始加)
+    } progress;
+
+    // 开始一次新的模拟，此后task_list中的时间均相对于此时
+    void start_simulation() {
+        progress = {};
+        progress.start_round = info.round;
+        Sim_result& res = progress.res;
+        res.first_succ = res.dmg_time = res.first_enc = res.next_old = MAX_ROUND + 1;
+        for (int i = 0; i < 2; i++) std::stable_sort(task_list[i].begin(), task_list[i].end(), __cmp_downgrade_last); // 将降级操作排到最后(因为操作从最后开始加)，其余顺序不变
+    }
 
-        for (int _r = 0; _r < round; ++_r) {
-            round_count++;
+    /**
+     * @brief 继续模拟，直至自start_simulation起共模拟round回合或提前停止
+     * @return bool 是否提前停止
+     */
+    bool continue_simulation(int round, int stopping_f_succ) {
+        Sim_result& res = progress.res;
+        if (res.early_stop) return true;
+        if (res.first_succ < stopping_f_succ) return res.early_stop = true; // 从检查点恢复时，可能已满足停止条件
+        for (int& _r = progress.done; _r < round; ) {
+            if (ctx && ctx->cancelled()) {
+                res.early_stop = true;
+                break;
+            }
+            if (ctx) ctx->round_count++;
             step_simulation(1, _r);
             if (res.first_succ > MAX_ROUND) for (const Ant& a : info.ants) {
                 if (a.player == pid || distance(a.x, a.y, Base::POSITION[pid][0], Base::POSITION[pid][1]) > DANGER_RANGE) continue;
-                if (!std::count(enc_ant_id.begin(), enc_ant_id.end(), a.id)) {
-                    enc_ant_id.push_back(a.id);
+                if (!std::count(progress.enc_ant_id.begin(), progress.enc_ant_id.end(), a.id)) {
+                    progress.enc_ant_id.push_back(a.id);
                     if (res.first_enc > MAX_ROUND) res.first_enc = _r;
                 }
             }
             if (res.first_succ > MAX_ROUND && INIT_HEALTH != info.bases[pid].hp) res.first_succ = _r;
             if (res.dmg_time > MAX_ROUND && INIT_HEALTH != info.bases[!pid].hp) res.dmg_time = _r;
+            _r++;
 
             if (res.first_succ < stopping_f_succ) { // “挂了就停止”仍然可以考虑
                 res.early_stop = true;
                 break;
             }
         }
+        return res.early_stop;
+    }
 
+    // 当前的模拟结果
+    Sim_result simulation_result() const {
+        Sim_result res = progress.res;
         res.old_ant = old_ants[pid];
-        if (res.old_ant) res.next_old = next_old[pid] - start_round;
+        if (res.old_ant) res.next_old = next_old[pid] - progress.start_round;
         res.old_opp = old_ants[!pid];
-        if (res.old_opp) res.next_old_opp = next_old[!pid] - start_round;
+        if (res.old_opp) res.next_old_opp = next_old[!pid] - progress.start_round;
 
-        res.danger_encounter = enc_ant_id.size();
+        res.danger_encounter = progress.enc_ant_id.size();
         res.succ_ant = INIT_HEALTH - info.bases[pid].hp;
         res.dmg_dealt = INIT_HEALTH - info.bases[!pid].hp;
         return res;
@@ -151,10 +218,15 @@ private:
     }
     void __add_op(int _r, int player) {
         std::vector<Task>& tasks = task_list[player];
+        std::optional<Op_validator> validator; // 本回合有操作时才构造
         for (int i = tasks.size()-1; i >= 0; i--) {
             const Task& curr_task = tasks[i];
             if (curr_task.round == _r) {
-                if (!info.is_operation_valid(player, operations[player], curr_task.op))
+                if (!validator) {
+                    validator.emplace(info, player);
+                    for (const Operation& op : operations[player]) validator->push(op);
+                }
+                if (!validator->append(curr_task.op))
                     fprintf(stderr, "[w] Adding invalid operation for player %d at sim round %d: %s\n", player, _r, curr_task.op.str(true).c_str());
                 else operations[player].push_back(curr_task.op);
                 tasks.erase(tasks.begin() + i);
@@ -176,25 +248,32 @@ private:
      */
     void attack_ants() {
         /* Lightning Storm Attack */
-        for (const SuperWeapon& sw: info.super_weapons) {
-            if(sw.type != SuperWeaponType::LightningStorm) continue;
-            for (Ant &ant : info.ants) {
-                if (sw.is_in_range(ant.x, ant.y) && ant.player != sw.player) {
-                    ant.hp = 0;
-                    ant.state = AntState::Fail;
-                    info.update_coin(sw.player, ant.reward());
-                }
+        // 每方至多一个风暴，因此每只蚂蚁至多被对方的一个风暴击中，逐个蚂蚁查询作用区域即可
+        if (info.super_weapons.size()) for (Ant &ant : info.ants) {
+            if (info.is_struck_by_lightning(ant)) {
+                ant.hp = 0;
+                ant.state = AntState::Fail;
+                info.update_coin(!ant.player, ant.reward());
             }
         }
 
         /* Tower Attack */
         // Set deflector property
         for (Ant& ant: info.ants) ant.deflector = info.is_shielded_by_deflector(ant);
+        // 双方存活蚂蚁所在的格子。攻击只会减少存活的蚂蚁，因此回合内一直是实际占据情况的超集
+        Cell_set occupied[2];
+        for (const Ant& ant: info.ants) if (ant.is_alive()) occupied[ant.player].set(cell_index(ant.x, ant.y));
         // Attack
         for (Tower& tower: info.towers) {
             if (one_side && tower.player == attack_side) continue; // 不模拟进攻方的塔
             // Skip if shielded by EMP
             if (info.is_shielded_by_emp(tower)) continue;
+            // 射程内没有敌方蚂蚁时只需冷却
+            if ((tower.coverage() & occupied[!tower.player]).none()) {
+                tower.idle();
+                tower.damage = TOWER_INFO[tower.type].attack;
+                continue;
+            }
             // Try to attack
             auto targets = tower.attack(info.ants);
             // Get coins if tower killed the target
@@ -216,6 +295,7 @@ private:
      * @see #AntState for more information on the life cycle of an ant.
      */
     void move_ants() {
+        Move_table moves(info); // 移动期间信息素不变，同一格点、同一来向的蚂蚁共用一次next_move
         for (Ant& ant: info.ants) {
             // Update age regardless of the state
             ant.age++;
@@ -224,7 +304,7 @@ private:
             // 2) Check if too old
             if (ant.age > Ant::AGE_LIMIT) ant.state = AntState::TooOld;
             // 3) Move if possible (alive)
-            if (ant.state == AntState::Alive) ant.move(info.next_move(ant));
+            if (ant.state == AntState::Alive) ant.move(moves.next_move(ant));
             // 4) Check if success (Mark success even if it reaches the age limit)
             if (ant.x == Base::POSITION[!ant.player][0] && ant.y == Base::POSITION[!ant.player][1]) {
                 ant.state = AntState::Success;
@@ -252,14 +332,68 @@ private:
         }
     }
 
+    // 记录next_round会修改的全部状态。衰减会改写每个格点的信息素，且浮点运算不可精确逆推，因此整体记录
+    void save_round(Undo_log& log) {
+        log.save(info.round);
+        log.save(info.towers);
+        log.save(info.ants);
+        log.save(info.bases);
+        log.save(info.coins);
+        if (one_side) log.save(info.pheromone[attack_side]);
+        else log.save(info.pheromone);
+        log.save(info.super_weapon_cd);
+        log.save(info.next_ant_id);
+        log.save(ants_killed);
+        log.save(old_ants);
+        log.save(next_old);
+    }
+
+    /**
+     * @brief 回合末对蚂蚁的单次遍历：按状态更新信息素，统计被击杀及老死的蚂蚁，并原地保序地移除死亡及成功的蚂蚁
+     * @note 与依次调用GameInfo::update_pheromone_for_ants、按状态计数、GameInfo::clear_dead_and_succeeded_ants完全一致
+     */
+    void settle_ants() {
+        int killed[2] = {}, old[2] = {};
+        int n = 0;
+        for (int i = 0; i < info.ants.size(); i++) {
+            const Ant& ant = info.ants[i];
+            info.update_pheromone(ant);
+            if (ant.state == AntState::Fail) killed[ant.player]++;
+            else if (ant.state == AntState::TooOld) old[ant.player]++;
+            else if (ant.state != AntState::Success) {
+                if (n != i) info.ants[n] = ant;
+                n++;
+            }
+        }
+        info.ants.erase(info.ants.begin() + n, info.ants.end());
+        for (int i = 0; i < 2; i++) {
+            ants_killed[!i] = killed[i];
+            if (old[i] && next_old[!i] > MAX_ROUND) next_old[!i] = info.round;
+            old_ants[!i] += old[i];
+        }
+    }
+
 public:
+    // 撤销日志的当前位置。只能在操作列表为空时（如两次推进之间）调用，task_list不被记录，由调用者自行维护
+    int mark() const {
+        assert(undo && operations[0].empty() && operations[1].empty());
+        return undo->mark();
+    }
+    // 恢复到mark时的局面及计数器，并清空操作列表
+    void rollback(int mark) {
+        undo->rollback(mark);
+        operations[0].clear();
+        operations[1].clear();
+    }
+
     /**
      * @brief Apply all operations in "operations[player_id]" to current state.
      * @param player_id The player.
      */
     void apply_operations_of_player(int player_id) {
         // 1) count down long-lasting weapons' left-time
-        info.count_down_super_weapons_left_time(player_id);
+        if (undo) info.count_down_super_weapons_left_time(player_id, *undo);
+        else info.count_down_super_weapons_left_time(player_id);
         // 2) apply opponent's operations
         for (auto& op: operations[player_id]) {
             if (!info.is_operation_valid(player_id, op)) {
@@ -267,7 +401,8 @@ public:
                 std::string enemy_op = "full op list:";
                 for (const Operation& op : operations[player_id]) enemy_op += ' ' + op.str(true);
                 fprintf(stderr, (enemy_op + '\n').c_str());
-            } else info.apply_operation(player_id, op);
+            } else if (undo) info.apply_operation(player_id, op, *undo);
+            else info.apply_operation(player_id, op);
         }
     }
 
@@ -279,6 +414,7 @@ public:
     bool next_round() {
         // 1) Judge winner at MAX_ROUND
         if (info.round == MAX_ROUND) return false;
+        if (undo) save_round(*undo);
         // 2) Towers attack ants
         attack_ants();
         // 3) Ants move
@@ -286,17 +422,13 @@ public:
         // 4) Update pheromone
         if (one_side) info.global_pheromone_attenuation(attack_side); // 仅模拟进攻方的信息素
         else info.global_pheromone_attenuation();
-        info.update_pheromone_for_ants(); // 正常update信息素，因为防御方不会出蚂蚁
         // 5) Clear dead and succeeded ants
-        for (int i = 0; i < 2; i++) ants_killed[!i] = std::count_if(info.ants.begin(), info.ants.end(), [i](const Ant& a){ return a.state == AntState::Fail && a.player == i; });
-        for (int i = 0; i < 2; i++) {
-            int cnt = std::count_if(info.ants.begin(), info.ants.end(), [i](const Ant& a){ return a.state == AntState::TooOld && a.player == i; });
-            if (cnt && next_old[!i] > MAX_ROUND) next_old[!i] = info.round;
-            old_ants[!i] += cnt;
-        }
-        info.clear_dead_and_succeeded_ants();
+        if (settled_ants) settled_ants->assign(info.ants.begin(), info.ants.end());
+        settle_ants(); // 正常update信息素，因为防御方不会出蚂蚁
         // 6) Barracks generate new ants
+        int survivor_count = info.ants.size();
         generate_ants();
+        if (settled_ants) settled_ants->insert(settled_ants->end(), info.ants.begin() + survivor_count, info.ants.end());
         if (info.round == MAX_ROUND-1) {
             for (const Ant& a : info.ants) {
                 next_old[!a.player] = info.round; // 最后时刻没杀死的蚂蚁都是“old”
@@ -317,5 +449,3 @@ public:
         return true;
     }
 };
-int Simulator::sim_count = 0;
-int Simulator::round_count = 0;
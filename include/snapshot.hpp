@@ -0,0 +1,317 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "game_info.hpp"
+
+/**
+ * GameInfo的二进制快照
+ *
+ * 布局（均为本机字节序，各段按8字节对齐，偏移量相对于文件开头）：
+ * @verbatim
+ * Header                                  固定长度，header_size字段记录其实际长度
+ * Tower_record[tower_count]               @ tower_offset
+ * Ant_record[ant_count]                   @ ant_offset
+ * Super_weapon_record[super_weapon_count] @ super_weapon_offset
+ * double[2][MAP_SIZE][MAP_SIZE]           @ pheromone_offset
+ * uint8_t[path_size]                      @ path_offset，全部蚂蚁的移动方向依次拼接
+ * @endverbatim
+ * 所有记录均可平凡复制，因此快照可以直接mmap后通过Snapshot_view读取，无需解析。
+ * 新版本只能在Header末尾及各记录末尾之外追加内容；读取时拒绝magic不符或版本高于当前版本的快照。
+ */
+namespace snapshot {
+    constexpr uint32_t MAGIC = 0x50414e53; // "SNAP"，字节序不同时无法通过校验
+    constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t header_size;
+        uint32_t total_size;
+
+        uint64_t seed;
+        int32_t round;
+        int32_t next_ant_id;
+        int32_t next_tower_id;
+        int32_t coins[2];
+        int32_t base_hp[2];
+        int32_t base_gen_speed_level[2];
+        int32_t base_ant_level[2];
+        int32_t super_weapon_cd[2][SuperWeaponCount];
+
+        uint32_t tower_count, tower_offset;
+        uint32_t ant_count, ant_offset;
+        uint32_t super_weapon_count, super_weapon_offset;
+        uint32_t pheromone_offset;
+        uint32_t path_size, path_offset;
+    };
+
+    struct Tower_record {
+        int32_t id, player, x, y, type, cd;
+    };
+
+    struct Ant_record {
+        int32_t id, player, x, y, hp, level, age, state, evasion;
+        uint32_t path_begin, path_len; // 在路径段中的起始下标及长度
+        uint8_t deflector;
+    };
+
+    struct Super_weapon_record {
+        int32_t type, player, x, y, left_time;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % 8 == 0);
+    static_assert(std::is_trivially_copyable_v<Tower_record> && std::is_trivially_copyable_v<Ant_record>);
+    static_assert(std::is_trivially_copyable_v<Super_weapon_record>);
+
+    inline uint32_t align8(size_t n) {
+        return (n + 7) & ~size_t(7);
+    }
+}
+
+/**
+ * @brief 将局面编码为二进制快照
+ * @param info 给定的局面
+ * @return std::string 快照的全部字节
+ */
+inline std::string encode_snapshot(const GameInfo& info) {
+    using namespace snapshot;
+    Header h{};
+    h.magic = MAGIC;
+    h.version = VERSION;
+    h.header_size = sizeof(Header);
+    h.seed = info.seed;
+    h.round = info.round;
+    h.next_ant_id = info.next_ant_id;
+    h.next_tower_id = info.next_tower_id;
+    for (int i = 0; i < 2; i++) {
+        h.coins[i] = info.coins[i];
+        h.base_hp[i] = info.bases[i].hp;
+        h.base_gen_speed_level[i] = info.bases[i].gen_speed_level;
+        h.base_ant_level[i] = info.bases[i].ant_level;
+        for (int j = 0; j < SuperWeaponCount; j++) h.super_weapon_cd[i][j] = info.super_weapon_cd[i][j];
+    }
+
+    h.tower_count = info.towers.size();
+    h.ant_count = info.ants.size();
+    h.super_weapon_count = info.super_weapons.size();
+    h.path_size = 0;
+    for (const Ant& a : info.ants) h.path_size += a.path.size();
+
+    h.tower_offset = align8(sizeof(Header));
+    h.ant_offset = align8(h.tower_offset + h.tower_count * sizeof(Tower_record));
+    h.super_weapon_offset = align8(h.ant_offset + h.ant_count * sizeof(Ant_record));
+    h.pheromone_offset = align8(h.super_weapon_offset + h.super_weapon_count * sizeof(Super_weapon_record));
+    h.path_offset = h.pheromone_offset + sizeof(info.pheromone);
+    h.total_size = align8(h.path_offset + h.path_size);
+
+    std::string buf(h.total_size, '\0');
+    char* base = &buf[0];
+    std::memcpy(base, &h, sizeof(h));
+
+    Tower_record* towers = reinterpret_cast<Tower_record*>(base + h.tower_offset);
+    for (const Tower& t : info.towers) *towers++ = {t.id, t.player, t.x, t.y, t.type, t.cd};
+
+    Ant_record* ants = reinterpret_cast<Ant_record*>(base + h.ant_offset);
+    uint8_t* path = reinterpret_cast<uint8_t*>(base + h.path_offset);
+    uint32_t path_begin = 0;
+    for (const Ant& a : info.ants) {
+        *ants++ = {a.id, a.player, a.x, a.y, a.hp, a.level, a.age, a.state, a.evasion, path_begin, (uint32_t)a.path.size(), a.deflector};
+        for (int d : a.path) path[path_begin++] = d;
+    }
+
+    Super_weapon_record* sws = reinterpret_cast<Super_weapon_record*>(base + h.super_weapon_offset);
+    for (const SuperWeapon& s : info.super_weapons) *sws++ = {s.type, s.player, s.x, s.y, s.left_time};
+
+    std::memcpy(base + h.pheromone_offset, info.pheromone, sizeof(info.pheromone));
+    return buf;
+}
+
+/**
+ * @brief 将局面写入快照文件
+ * @return bool 是否写入成功
+ */
+inline bool save_snapshot(const GameInfo& info, const std::string& path) {
+    std::string buf = encode_snapshot(info);
+    std::FILE* fout = std::fopen(path.c_str(), "wb");
+    if (!fout) return false;
+    bool ok = std::fwrite(buf.data(), 1, buf.size(), fout) == buf.size();
+    return std::fclose(fout) == 0 && ok;
+}
+
+// 快照的只读视图，不拷贝也不解析数据，底层内存须在视图的生命周期内有效且按8字节对齐
+class Snapshot_view {
+    public:
+    /**
+     * @brief 校验并包装一段快照数据
+     * @param data 快照数据
+     * @param size 数据长度
+     * @param err 校验失败时的错误信息
+     * @return bool 是否为合法的快照
+     */
+    bool attach(const void* data, size_t size, std::string& err) {
+        using namespace snapshot;
+        base = static_cast<const char*>(data);
+        h = nullptr;
+        if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(base) % 8) return err = "truncated or misaligned snapshot", false;
+        const Header* hd = reinterpret_cast<const Header*>(base);
+        if (hd->magic != MAGIC) return err = "bad snapshot magic", false;
+        if (hd->version > VERSION || hd->header_size < sizeof(Header)) return err = str_wrap("unsupported snapshot version %u", hd->version), false;
+        if (hd->total_size > size) return err = "truncated snapshot", false;
+
+        auto in_bounds = [&](uint64_t offset, uint64_t bytes) { return offset % 8 == 0 && offset + bytes <= hd->total_size; };
+        bool ok = in_bounds(hd->tower_offset, uint64_t(hd->tower_count) * sizeof(Tower_record))
+            && in_bounds(hd->ant_offset, uint64_t(hd->ant_count) * sizeof(Ant_record))
+            && in_bounds(hd->super_weapon_offset, uint64_t(hd->super_weapon_count) * sizeof(Super_weapon_record))
+            && in_bounds(hd->pheromone_offset, sizeof(GameInfo::pheromone))
+            && uint64_t(hd->path_offset) + hd->path_size <= hd->total_size;
+        for (uint32_t i = 0; ok && i < hd->ant_count; i++) {
+            const Ant_record& a = reinterpret_cast<const Ant_record*>(base + hd->ant_offset)[i];
+            ok = uint64_t(a.path_begin) + a.path_len <= hd->path_size;
+        }
+        if (!ok) return err = "corrupted snapshot section table", false;
+
+        // 局面中的容器容量固定，超出的计数只可能来自损坏的数据
+        ok = hd->tower_count <= uint32_t(MAX_TOWER_NUM) && hd->ant_count <= uint32_t(MAX_ANT_NUM)
+            && hd->super_weapon_count <= uint32_t(MAX_SUPER_WEAPON_NUM);
+        for (uint32_t i = 0; ok && i < hd->ant_count; i++)
+            ok = reinterpret_cast<const Ant_record*>(base + hd->ant_offset)[i].path_len <= uint32_t(Ant::MAX_PATH_LENGTH);
+        for (uint32_t i = 0; ok && i < hd->super_weapon_count; i++) {
+            const Super_weapon_record& s = reinterpret_cast<const Super_weapon_record*>(base + hd->super_weapon_offset)[i];
+            ok = s.type > 0 && s.type < EmergencyEvasion && s.x >= 0 && s.x < MAP_SIZE && s.y >= 0 && s.y < MAP_SIZE; // 用于计算作用区域
+        }
+        if (!ok) return err = "snapshot exceeds GameInfo capacity", false;
+        h = hd;
+        return true;
+    }
+
+    const snapshot::Header& header() const { return *h; }
+    const snapshot::Tower_record* towers() const { return reinterpret_cast<const snapshot::Tower_record*>(base + h->tower_offset); }
+    const snapshot::Ant_record* ants() const { return reinterpret_cast<const snapshot::Ant_record*>(base + h->ant_offset); }
+    const snapshot::Super_weapon_record* super_weapons() const { return reinterpret_cast<const snapshot::Super_weapon_record*>(base + h->super_weapon_offset); }
+    const double (*pheromone() const)[MAP_SIZE][MAP_SIZE] { return reinterpret_cast<const double (*)[MAP_SIZE][MAP_SIZE]>(base + h->pheromone_offset); }
+    const uint8_t* path() const { return reinterpret_cast<const uint8_t*>(base + h->path_offset); }
+
+    /**
+     * @brief 将快照恢复到给定的局面中，复用其中各容器已分配的内存
+     * @param out 被覆盖的局面
+     */
+    void restore(GameInfo& out) const {
+        out.seed = h->seed;
+        out.round = h->round;
+        out.next_ant_id = h->next_ant_id;
+        out.next_tower_id = h->next_tower_id;
+        for (int i = 0; i < 2; i++) {
+            out.coins[i] = h->coins[i];
+            out.bases[i].hp = h->base_hp[i];
+            out.bases[i].gen_speed_level = h->base_gen_speed_level[i];
+            out.bases[i].ant_level = h->base_ant_level[i];
+            for (int j = 0; j < SuperWeaponCount; j++) out.super_weapon_cd[i][j] = h->super_weapon_cd[i][j];
+        }
+
+        out.towers.clear();
+        for (uint32_t i = 0; i < h->tower_count; i++) {
+            const snapshot::Tower_record& t = towers()[i];
+            out.towers.emplace_back(t.id, t.player, t.x, t.y, static_cast<TowerType>(t.type));
+            out.towers.back().cd = t.cd; // Tower的构造函数会重置cd
+        }
+
+        out.ants.clear();
+        for (uint32_t i = 0; i < h->ant_count; i++) {
+            const snapshot::Ant_record& a = ants()[i];
+            Ant& ant = out.ants.emplace_back(a.id, a.player, a.x, a.y, a.hp, a.level, a.age, static_cast<AntState>(a.state));
+            ant.evasion = a.evasion;
+            ant.deflector = a.deflector;
+            ant.path.assign(path() + a.path_begin, path() + a.path_begin + a.path_len);
+        }
+
+        out.super_weapons.clear();
+        for (uint32_t i = 0; i < h->super_weapon_count; i++) {
+            const snapshot::Super_weapon_record& s = super_weapons()[i];
+            SuperWeapon& sw = out.super_weapons.emplace_back(static_cast<SuperWeaponType>(s.type), s.player, s.x, s.y);
+            sw.left_time = s.left_time;
+        }
+        out.update_super_weapon_areas();
+
+        std::memcpy(out.pheromone, pheromone(), sizeof(out.pheromone));
+    }
+
+    // 将快照恢复为一个新的局面
+    GameInfo restore() const {
+        GameInfo ans(h->seed);
+        restore(ans);
+        return ans;
+    }
+
+    private:
+    const char* base = nullptr;
+    const snapshot::Header* h = nullptr;
+};
+
+// 快照文件，可用时以mmap只读映射，否则整体读入内存
+class Snapshot_file {
+    public:
+    Snapshot_file() = default;
+    Snapshot_file(const Snapshot_file&) = delete;
+    Snapshot_file& operator=(const Snapshot_file&) = delete;
+    ~Snapshot_file() { close(); }
+
+    /**
+     * @brief 打开并校验快照文件
+     * @param path 文件路径
+     * @param err 失败时的错误信息
+     * @return bool 是否成功
+     */
+    bool open(const std::string& path, std::string& err) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return err = "cannot open " + path, false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) mapped = p, mapped_size = st.st_size;
+        }
+        ::close(fd);
+        if (mapped) return view.attach(mapped, mapped_size, err);
+#endif
+        std::FILE* fin = std::fopen(path.c_str(), "rb");
+        if (!fin) return err = "cannot open " + path, false;
+        std::fseek(fin, 0, SEEK_END);
+        long size = std::ftell(fin);
+        std::fseek(fin, 0, SEEK_SET);
+        buffer.assign(size > 0 ? (size + 7) / 8 : 0, 0);
+        bool ok = size > 0 && std::fread(buffer.data(), 1, size, fin) == (size_t)size;
+        std::fclose(fin);
+        if (!ok) return err = "cannot read " + path, false;
+        return view.attach(buffer.data(), size, err);
+    }
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped) munmap(mapped, mapped_size);
+#endif
+        mapped = nullptr;
+        mapped_size = 0;
+        buffer.clear();
+    }
+
+    const Snapshot_view& get() const { return view; }
+
+    private:
+    void* mapped = nullptr;
+    size_t mapped_size = 0;
+    std::vector<uint64_t> buffer; // 无法mmap时的后备存储，以uint64_t保证对齐
+    Snapshot_view view;
+};
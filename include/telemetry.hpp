@@ -0,0 +1,156 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "simulate.hpp"
+
+/**
+ * 搜索遥测：逐回合记录决策中各搜索块的开销与效果，写入CSV文件，并将各搜索块至今的汇总写入另一个CSV文件
+ *
+ * 每个搜索块以begin开始、end结束，其间每评估一个候选调用一次candidate，候选成为当前最优时再调用best。每行的各列为：
+ *   round       回合数
+ *   block       搜索块的名称
+ *   generated   生成的候选数
+ *   evaluated   实际评估的候选数（其余被预筛、剪枝或因超时跳过）
+ *   early_stops 评估中提前停止的候选数
+ *   sims        构造的Simulator数（含对方防守等辅助模拟）
+ *   sim_rounds  模拟的回合数
+ *   cache_hits  命中预搜索结果的评估数
+ *   time_ms     墙钟时间
+ *   best_rank   最终选出的候选在评估顺序中的名次（从1起），0表示没有候选取代块开始时的最优
+ *   best_index  该候选在生成顺序中的下标，没有时为-1
+ *   best_f_succ/best_dmg 该候选的first_succ及dmg_dealt，没有时为-1
+ *
+ * 汇总文件每行一个搜索块，在每个搜索块结束时整体重写，因此对局提前结束（judger直接结束进程）时也是完整的。各列为：
+ *   block ~ time_ms  同上，为全局累计
+ *   replaced         有候选取代块开始时的最优的次数
+ *   mean_best_rank   这些次数中best_rank的平均值，没有时为0
+ */
+class Search_telemetry {
+    public:
+    Search_telemetry() = default;
+    Search_telemetry(const Search_telemetry&) = delete;
+    Search_telemetry& operator=(const Search_telemetry&) = delete;
+    ~Search_telemetry() { close(); }
+
+    /**
+     * @brief 打开逐回合的文件并写入表头；未打开时其余接口均不做任何事
+     * @param path 逐回合记录的路径
+     * @param summary_path 汇总的路径
+     * @return bool 是否成功
+     */
+    bool open(const char* path, const char* summary_path) {
+        close();
+        file = std::fopen(path, "w");
+        if (!file) return false;
+        this->summary_path = summary_path;
+        std::fprintf(file, "round,block,generated,evaluated,early_stops,sims,sim_rounds,cache_hits,time_ms,best_rank,best_index,best_f_succ,best_dmg\n");
+        return true;
+    }
+    bool is_open() const { return file; }
+
+    /**
+     * @brief 开始记录一个搜索块
+     * @param name 搜索块的名称，各回合应保持一致
+     * @param ctx 决策上下文，以其中的计数器统计开销
+     * @param generated 生成的候选数
+     */
+    void begin(const char* name, const Game_context& ctx, int generated) {
+        if (!file) return;
+        cur = Block{name};
+        cur.generated = generated;
+        cur.sims = -ctx.sim_count;
+        cur.sim_rounds = -ctx.round_count;
+        cur.cache_hits = -ctx.cache_hits;
+        start = std::chrono::steady_clock::now();
+    }
+
+    // 记录一个已评估的候选
+    void candidate(const Sim_result& res) {
+        if (!file) return;
+        cur.evaluated++;
+        cur.early_stops += res.early_stop;
+    }
+
+    /**
+     * @brief 记录最近评估的候选成为了当前最优
+     * @param res 评估结果
+     * @param index 候选在生成顺序中的下标
+     */
+    void best(const Sim_result& res, int index) {
+        if (!file) return;
+        cur.best_rank = cur.evaluated;
+        cur.best_index = index;
+        cur.best_f_succ = res.first_succ;
+        cur.best_dmg = res.dmg_dealt;
+    }
+
+    // 结束当前搜索块并写入一行
+    void end(const Game_context& ctx, int round) {
+        if (!file) return;
+        cur.sims += ctx.sim_count;
+        cur.sim_rounds += ctx.round_count;
+        cur.cache_hits += ctx.cache_hits;
+        cur.time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        write_row(std::to_string(round), cur, cur.best_rank);
+        std::fflush(file);
+
+        Block* total = nullptr;
+        for (Block& b : totals) if (b.name == cur.name) total = &b;
+        if (!total) total = &totals.emplace_back(Block{cur.name});
+        total->generated += cur.generated;
+        total->evaluated += cur.evaluated;
+        total->early_stops += cur.early_stops;
+        total->sims += cur.sims;
+        total->sim_rounds += cur.sim_rounds;
+        total->cache_hits += cur.cache_hits;
+        total->time_ms += cur.time_ms;
+        if (cur.best_rank) {
+            total->best_rank += cur.best_rank;
+            total->replaced++;
+        }
+        write_summary();
+    }
+
+    // 关闭文件（析构时也会调用），汇总已在每个搜索块结束时写入
+    void close() {
+        if (!file) return;
+        std::fclose(file);
+        file = nullptr;
+        totals.clear();
+    }
+
+    private:
+    struct Block {
+        std::string name;
+        int generated = 0, evaluated = 0, early_stops = 0;
+        long long sims = 0, sim_rounds = 0, cache_hits = 0;
+        double time_ms = 0;
+        int best_rank = 0, best_index = -1, best_f_succ = -1, best_dmg = -1;
+        int replaced = 0; // 仅用于汇总
+    };
+
+    std::FILE* file = nullptr;
+    std::string summary_path;
+    Block cur;
+    std::chrono::steady_clock::time_point start;
+    std::vector<Block> totals; // 按首次出现的顺序
+
+    void write_row(const std::string& round, const Block& b, double rank) {
+        std::fprintf(file, "%s,%s,%d,%d,%d,%lld,%lld,%lld,%.3lf,%g,%d,%d,%d\n", round.c_str(), b.name.c_str(),
+            b.generated, b.evaluated, b.early_stops, b.sims, b.sim_rounds, b.cache_hits, b.time_ms, rank, b.best_index, b.best_f_succ, b.best_dmg);
+    }
+
+    void write_summary() const {
+        std::FILE* f = std::fopen(summary_path.c_str(), "w");
+        if (!f) return;
+        std::fprintf(f, "block,generated,evaluated,early_stops,sims,sim_rounds,cache_hits,time_ms,replaced,mean_best_rank\n");
+        for (const Block& b : totals) std::fprintf(f, "%s,%d,%d,%d,%lld,%lld,%lld,%.3lf,%d,%g\n", b.name.c_str(),
+            b.generated, b.evaluated, b.early_stops, b.sims, b.sim_rounds, b.cache_hits, b.time_ms, b.replaced,
+            b.replaced > 0 ? double(b.best_rank) / b.replaced : 0);
+        std::fclose(f);
+    }
+};
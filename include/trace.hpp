@@ -0,0 +1,463 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "snapshot.hpp"
+
+/**
+ * 对局轨迹：逐回合记录收到的局面、双方操作及我方对下一回合的预测
+ *
+ * 文件由一个File_header及若干记录组成，每条记录为{uint32 type, uint32 size}加上size字节的内容，并补齐到8字节。
+ * 每回合以一条局面记录（STATE_KEYFRAME或STATE_DELTA）开始，其后可以跟随SELF_OPS、OPPONENT_OPS及PREDICTION。
+ *   - STATE_KEYFRAME：完整的二进制快照（见snapshot.hpp），每keyframe_interval回合写一次
+ *   - STATE_DELTA：相对上一回合局面的增量：标量字段、超级武器、按顺序排列的塔/蚂蚁（未变化的只写id）、
+ *     以及在上一回合信息素做一次全局衰减后仍不一致的信息素格点
+ *   - PREDICTION：相对同一回合局面的增量，编码方式同STATE_DELTA
+ *   - SELF_OPS/OPPONENT_OPS：操作列表
+ * 读取某一回合时从最近的关键帧开始依次应用增量；顺序读取时每回合只需应用一次增量。
+ */
+namespace trace {
+    constexpr uint32_t MAGIC = 0x45435254; // "TRCE"
+    constexpr uint32_t VERSION = 1;
+
+    enum Record_type : uint32_t {
+        STATE_KEYFRAME = 1,
+        STATE_DELTA = 2,
+        SELF_OPS = 3,
+        OPPONENT_OPS = 4,
+        PREDICTION = 5
+    };
+
+    struct File_header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t keyframe_interval;
+        int32_t player; // 记录方的玩家编号
+    };
+
+    // 追加写入的字节缓冲
+    class Byte_writer {
+        public:
+        std::string buf;
+
+        template<typename T>
+        void put(const T& val) {
+            buf.append(reinterpret_cast<const char*>(&val), sizeof(T));
+        }
+    };
+
+    // 顺序读取的字节游标，越界时置ok为false并返回0
+    class Byte_reader {
+        public:
+        Byte_reader(const char* data, size_t size) : p(data), end(data + size) {}
+
+        bool ok = true;
+
+        template<typename T>
+        T get() {
+            T val{};
+            if (size_t(end - p) < sizeof(T)) {
+                ok = false;
+                return val;
+            }
+            std::memcpy(&val, p, sizeof(T));
+            p += sizeof(T);
+            return val;
+        }
+
+        private:
+        const char* p;
+        const char* end;
+    };
+
+    using Pheromone_grid = double[2][MAP_SIZE][MAP_SIZE];
+
+    // 信息素的全局衰减，与GameInfo::global_pheromone_attenuation一致；即使不一致，也只会使增量变大而不影响正确性
+    inline void attenuate(Pheromone_grid& grid) {
+        for (int i = 0; i < 2; ++i) for (int j = 0; j < MAP_SIZE; ++j) for (int k = 0; k < MAP_SIZE; ++k)
+            grid[i][j][k] = PHEROMONE_ATTENUATING_RATIO * grid[i][j][k] + (1 - PHEROMONE_ATTENUATING_RATIO) * PHEROMONE_INIT;
+    }
+
+    inline bool same_tower(const Tower& a, const Tower& b) {
+        return a.id == b.id && a.player == b.player && a.x == b.x && a.y == b.y && a.type == b.type && a.cd == b.cd;
+    }
+    inline bool same_ant(const Ant& a, const Ant& b) {
+        return a.id == b.id && a.player == b.player && a.x == b.x && a.y == b.y && a.hp == b.hp && a.level == b.level && a.age == b.age
+            && a.state == b.state && a.evasion == b.evasion && a.deflector == b.deflector && a.path == b.path;
+    }
+
+    /**
+     * @brief 编码cur相对base的增量
+     * @param base 基准局面
+     * @param cur 当前局面
+     * @param out 输出缓冲
+     */
+    inline void encode_delta(const GameInfo& base, const GameInfo& cur, Byte_writer& out) {
+        out.put<int32_t>(cur.round);
+        out.put<int32_t>(cur.next_ant_id);
+        out.put<int32_t>(cur.next_tower_id);
+        for (int i = 0; i < 2; i++) {
+            out.put<int32_t>(cur.coins[i]);
+            out.put<int32_t>(cur.bases[i].hp);
+            out.put<int32_t>(cur.bases[i].gen_speed_level);
+            out.put<int32_t>(cur.bases[i].ant_level);
+            for (int j = 0; j < SuperWeaponCount; j++) out.put<int32_t>(cur.super_weapon_cd[i][j]);
+        }
+
+        out.put<uint16_t>(cur.super_weapons.size());
+        for (const SuperWeapon& s : cur.super_weapons) out.put(snapshot::Super_weapon_record{s.type, s.player, s.x, s.y, s.left_time});
+
+        // 塔与蚂蚁按当前顺序写出，与基准局面中同id者相同时只写id
+        auto find_id = [](const auto& v, int id) { return std::find_if(v.begin(), v.end(), [id](const auto& e) { return e.id == id; }); };
+        out.put<uint16_t>(cur.towers.size());
+        for (const Tower& t : cur.towers) {
+            auto it = find_id(base.towers, t.id);
+            bool changed = it == base.towers.end() || !same_tower(*it, t);
+            out.put<int32_t>(t.id);
+            out.put<uint8_t>(changed);
+            if (changed) out.put(snapshot::Tower_record{t.id, t.player, t.x, t.y, t.type, t.cd});
+        }
+        out.put<uint16_t>(cur.ants.size());
+        for (const Ant& a : cur.ants) {
+            auto it = find_id(base.ants, a.id);
+            bool changed = it == base.ants.end() || !same_ant(*it, a);
+            out.put<int32_t>(a.id);
+            out.put<uint8_t>(changed);
+            if (!changed) continue;
+            // 路径只写出与基准局面不同的后缀
+            uint16_t keep = 0;
+            if (it != base.ants.end())
+                while (keep < it->path.size() && keep < a.path.size() && it->path[keep] == a.path[keep]) keep++;
+            for (int32_t field : {a.player, a.x, a.y, a.hp, a.level, a.age, (int32_t)a.state, a.evasion}) out.put<int32_t>(field);
+            out.put<uint8_t>(a.deflector);
+            out.put<uint16_t>(keep);
+            out.put<uint16_t>(a.path.size() - keep);
+            for (size_t i = keep; i < a.path.size(); i++) out.put<uint8_t>(a.path[i]);
+        }
+
+        // 信息素：以基准局面衰减一回合后的值为预测，只写出不一致的格点
+        Pheromone_grid expected;
+        std::memcpy(expected, base.pheromone, sizeof(expected));
+        attenuate(expected);
+        size_t count_pos = out.buf.size();
+        out.put<uint16_t>(0);
+        uint16_t count = 0;
+        const double* e = &expected[0][0][0];
+        const double* c = &cur.pheromone[0][0][0];
+        for (int i = 0; i < 2 * MAP_SIZE * MAP_SIZE; i++) if (std::memcmp(e + i, c + i, sizeof(double))) {
+            out.put<uint16_t>(i);
+            out.put<double>(c[i]);
+            count++;
+        }
+        std::memcpy(&out.buf[count_pos], &count, sizeof(count));
+    }
+
+    /**
+     * @brief 在基准局面上应用增量
+     * @param base 基准局面
+     * @param in 增量数据
+     * @param out 结果局面，不可与base为同一对象
+     * @return bool 增量数据是否完整
+     */
+    inline bool apply_delta(const GameInfo& base, Byte_reader& in, GameInfo& out) {
+        out.seed = base.seed;
+        out.round = in.get<int32_t>();
+        out.next_ant_id = in.get<int32_t>();
+        out.next_tower_id = in.get<int32_t>();
+        for (int i = 0; i < 2; i++) {
+            out.coins[i] = in.get<int32_t>();
+            out.bases[i].hp = in.get<int32_t>();
+            out.bases[i].gen_speed_level = in.get<int32_t>();
+            out.bases[i].ant_level = in.get<int32_t>();
+            for (int j = 0; j < SuperWeaponCount; j++) out.super_weapon_cd[i][j] = in.get<int32_t>();
+        }
+
+        // 各容器容量固定，超出容量的计数及非法的超级武器只可能来自损坏的数据
+        out.super_weapons.clear();
+        int n = in.get<uint16_t>();
+        if (n > MAX_SUPER_WEAPON_NUM) return false;
+        for (int i = n; i > 0 && in.ok; i--) {
+            auto s = in.get<snapshot::Super_weapon_record>();
+            if (s.type <= 0 || s.type >= EmergencyEvasion || s.x < 0 || s.x >= MAP_SIZE || s.y < 0 || s.y >= MAP_SIZE) return false;
+            out.super_weapons.emplace_back(static_cast<SuperWeaponType>(s.type), s.player, s.x, s.y).left_time = s.left_time;
+        }
+        out.update_super_weapon_areas();
+
+        auto find_id = [](const auto& v, int id) { return std::find_if(v.begin(), v.end(), [id](const auto& e) { return e.id == id; }); };
+        out.towers.clear();
+        n = in.get<uint16_t>();
+        if (n > MAX_TOWER_NUM) return false;
+        for (int i = n; i > 0 && in.ok; i--) {
+            int id = in.get<int32_t>();
+            if (in.get<uint8_t>()) {
+                auto t = in.get<snapshot::Tower_record>();
+                out.towers.emplace_back(t.id, t.player, t.x, t.y, static_cast<TowerType>(t.type)).cd = t.cd; // Tower的构造函数会重置cd
+            } else {
+                auto it = find_id(base.towers, id);
+                if (it == base.towers.end()) return false;
+                out.towers.push_back(*it);
+            }
+        }
+        out.ants.clear();
+        n = in.get<uint16_t>();
+        if (n > MAX_ANT_NUM) return false;
+        for (int i = n; i > 0 && in.ok; i--) {
+            int id = in.get<int32_t>();
+            auto it = find_id(base.ants, id);
+            if (!in.get<uint8_t>()) {
+                if (it == base.ants.end()) return false;
+                out.ants.push_back(*it);
+                continue;
+            }
+            int32_t f[8];
+            for (int32_t& v : f) v = in.get<int32_t>();
+            Ant& a = out.ants.emplace_back(id, f[0], f[1], f[2], f[3], f[4], f[5], static_cast<AntState>(f[6]));
+            a.evasion = f[7];
+            a.deflector = in.get<uint8_t>();
+            uint16_t keep = in.get<uint16_t>(), add = in.get<uint16_t>();
+            if (keep && (it == base.ants.end() || keep > it->path.size())) return false;
+            if (keep + add > Ant::MAX_PATH_LENGTH) return false;
+            if (keep) a.path.assign(it->path.begin(), it->path.begin() + keep);
+            for (int k = 0; k < add; k++) a.path.push_back(in.get<uint8_t>());
+        }
+
+        std::memcpy(out.pheromone, base.pheromone, sizeof(out.pheromone));
+        attenuate(out.pheromone);
+        double* c = &out.pheromone[0][0][0];
+        for (int i = in.get<uint16_t>(); i > 0 && in.ok; i--) {
+            uint16_t idx = in.get<uint16_t>();
+            double val = in.get<double>();
+            if (idx >= 2 * MAP_SIZE * MAP_SIZE) return false;
+            c[idx] = val;
+        }
+        return in.ok;
+    }
+}
+
+// 对局轨迹的流式写入器
+class Trace_writer {
+    public:
+    Trace_writer() = default;
+    Trace_writer(const Trace_writer&) = delete;
+    Trace_writer& operator=(const Trace_writer&) = delete;
+    ~Trace_writer() { close(); }
+
+    /**
+     * @brief 创建轨迹文件
+     * @param path 文件路径
+     * @param player 记录方的玩家编号
+     * @param keyframe_interval 关键帧间隔（回合）
+     * @return bool 是否成功
+     */
+    bool open(const std::string& path, int player, int keyframe_interval = 32) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        interval = std::max(1, keyframe_interval);
+        trace::File_header h{trace::MAGIC, trace::VERSION, (uint32_t)interval, player};
+        return std::fwrite(&h, sizeof(h), 1, file) == 1;
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+        has_last = false;
+        since_keyframe = 0;
+    }
+
+    bool is_open() const { return file; }
+
+    // 记录从judger收到并更新后的局面，开始新的一回合
+    void record_state(const GameInfo& info) {
+        if (!file) return;
+        trace::Byte_writer out;
+        if (!has_last || ++since_keyframe >= interval) {
+            out.buf = encode_snapshot(info);
+            write_record(trace::STATE_KEYFRAME, out.buf);
+            since_keyframe = 0;
+        } else {
+            trace::encode_delta(last, info, out);
+            write_record(trace::STATE_DELTA, out.buf);
+        }
+        last = info;
+        has_last = true;
+    }
+    // 记录我方发出的操作
+    void record_self_operations(const std::vector<Operation>& ops) {
+        record_ops(trace::SELF_OPS, ops);
+    }
+    // 记录收到的对方操作
+    void record_opponent_operations(const std::vector<Operation>& ops) {
+        record_ops(trace::OPPONENT_OPS, ops);
+    }
+    // 记录我方对下一回合局面的预测，须在本回合的record_state之后调用
+    void record_prediction(const GameInfo& predicted) {
+        if (!file || !has_last) return;
+        trace::Byte_writer out;
+        trace::encode_delta(last, predicted, out);
+        write_record(trace::PREDICTION, out.buf);
+    }
+
+    private:
+    std::FILE* file = nullptr;
+    int interval = 32;
+    int since_keyframe = 0;
+    bool has_last = false;
+    GameInfo last{0}; // 上一次记录的局面，作为增量的基准
+
+    void record_ops(trace::Record_type type, const std::vector<Operation>& ops) {
+        if (!file) return;
+        trace::Byte_writer out;
+        out.put<uint16_t>(ops.size());
+        for (const Operation& op : ops) {
+            out.put<int32_t>(op.type);
+            out.put<int32_t>(op.arg0);
+            out.put<int32_t>(op.arg1);
+        }
+        write_record(type, out.buf);
+    }
+    void write_record(trace::Record_type type, const std::string& payload) {
+        static const char padding[8] = {};
+        uint32_t head[2] = {type, (uint32_t)payload.size()};
+        std::fwrite(head, sizeof(head), 1, file);
+        std::fwrite(payload.data(), 1, payload.size(), file);
+        std::fwrite(padding, 1, snapshot::align8(payload.size()) - payload.size(), file);
+        std::fflush(file); // 保证程序崩溃时已记录的回合完整
+    }
+};
+
+// 对局轨迹的读取器
+class Trace_reader {
+    public:
+    // 一个回合中各条记录的位置，偏移量为-1表示缺失
+    struct Round_index {
+        long long state = -1, self_ops = -1, opponent_ops = -1, prediction = -1;
+        bool keyframe = false;
+    };
+
+    trace::File_header header{};
+
+    /**
+     * @brief 读入轨迹文件并建立索引
+     * @param path 文件路径
+     * @param err 失败时的错误信息
+     * @return bool 是否成功，末尾不完整的记录将被忽略
+     */
+    bool open(const std::string& path, std::string& err) {
+        std::FILE* fin = std::fopen(path.c_str(), "rb");
+        if (!fin) return err = "cannot open " + path, false;
+        std::fseek(fin, 0, SEEK_END);
+        long size = std::ftell(fin);
+        std::fseek(fin, 0, SEEK_SET);
+        data.assign(size > 0 ? (size + 7) / 8 : 0, 0);
+        bool ok = size >= (long)sizeof(header) && std::fread(data.data(), 1, size, fin) == (size_t)size;
+        std::fclose(fin);
+        if (!ok) return err = "cannot read " + path, false;
+
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.magic != trace::MAGIC || header.version > trace::VERSION) return err = "not a supported trace file", false;
+
+        rounds.clear();
+        cached = -1;
+        const char* base = bytes();
+        for (size_t pos = snapshot::align8(sizeof(header)); pos + 8 <= (size_t)size; ) {
+            uint32_t head[2];
+            std::memcpy(head, base + pos, sizeof(head));
+            size_t next = pos + 8 + snapshot::align8(head[1]);
+            if (pos + 8 + head[1] > (size_t)size) break;
+            long long payload = pos + 8;
+            switch (head[0]) {
+                case trace::STATE_KEYFRAME:
+                case trace::STATE_DELTA:
+                    rounds.emplace_back();
+                    rounds.back().state = payload;
+                    rounds.back().keyframe = head[0] == trace::STATE_KEYFRAME;
+                    break;
+                case trace::SELF_OPS: if (rounds.size()) rounds.back().self_ops = payload; break;
+                case trace::OPPONENT_OPS: if (rounds.size()) rounds.back().opponent_ops = payload; break;
+                case trace::PREDICTION: if (rounds.size()) rounds.back().prediction = payload; break;
+            }
+            pos = next;
+        }
+        if (rounds.empty() || !rounds.front().keyframe) return err = "trace does not start with a keyframe", false;
+        return true;
+    }
+
+    // 记录的回合数（按局面记录计）
+    int size() const { return rounds.size(); }
+    const Round_index& index(int i) const { return rounds[i]; }
+
+    /**
+     * @brief 重建第i条局面记录对应的局面，顺序访问时只需应用一次增量
+     * @return const GameInfo* 重建结果，数据损坏时为nullptr
+     */
+    const GameInfo* state(int i) {
+        if (i < 0 || i >= (int)rounds.size()) return nullptr;
+        int start = i;
+        while (!rounds[start].keyframe) start--;
+        if (cached < start || cached > i) {
+            Snapshot_view view;
+            std::string err;
+            const char* p = bytes() + rounds[start].state;
+            if (!view.attach(p, payload_size(rounds[start].state), err)) return nullptr;
+            view.restore(states[slot]);
+            cached = start;
+        }
+        while (cached < i) {
+            long long pos = rounds[cached + 1].state;
+            trace::Byte_reader in(bytes() + pos, payload_size(pos));
+            if (!trace::apply_delta(states[slot], in, states[!slot])) {
+                cached = -1;
+                return nullptr;
+            }
+            slot = !slot;
+            cached++;
+        }
+        return &states[slot];
+    }
+
+    /**
+     * @brief 重建第i回合中我方对下一回合的预测
+     * @param out 预测的局面
+     * @return bool 该回合是否有预测记录
+     */
+    bool prediction(int i, GameInfo& out) {
+        const GameInfo* base = state(i);
+        if (!base || rounds[i].prediction < 0) return false;
+        trace::Byte_reader in(bytes() + rounds[i].prediction, payload_size(rounds[i].prediction));
+        return trace::apply_delta(*base, in, out);
+    }
+
+    std::vector<Operation> self_operations(int i) const { return read_ops(rounds[i].self_ops); }
+    std::vector<Operation> opponent_operations(int i) const { return read_ops(rounds[i].opponent_ops); }
+
+    private:
+    std::vector<uint64_t> data; // 以uint64_t保证关键帧的对齐
+    std::vector<Round_index> rounds;
+    int cached = -1; // states[slot]对应的记录下标
+    GameInfo states[2] = {GameInfo(0), GameInfo(0)}; // 当前重建结果及应用增量时的目标，交替使用
+    int slot = 0;
+
+    const char* bytes() const { return reinterpret_cast<const char*>(data.data()); }
+    uint32_t payload_size(long long payload) const {
+        uint32_t size;
+        std::memcpy(&size, bytes() + payload - 4, sizeof(size));
+        return size;
+    }
+    std::vector<Operation> read_ops(long long pos) const {
+        std::vector<Operation> ops;
+        if (pos < 0) return ops;
+        trace::Byte_reader in(bytes() + pos, payload_size(pos));
+        for (int i = in.get<uint16_t>(); i > 0 && in.ok; i--) {
+            OperationType type = static_cast<OperationType>(in.get<int32_t>());
+            int arg0 = in.get<int32_t>();
+            int arg1 = in.get<int32_t>();
+            ops.emplace_back(type, arg0, arg1);
+        }
+        return ops;
+    }
+};
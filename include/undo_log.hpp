@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "fixed_vector.hpp"
+
+/**
+ * 撤销日志：修改前记录对象的原始字节，回滚时按相反顺序写回
+ *
+ * 用于在同一个局面上做深度优先的搜索而不复制局面：mark取得当前位置，此后每次修改前save被修改的对象，
+ * rollback即恢复到mark时的状态。只能记录可平凡复制的对象（GameInfo的各字段、Simulator的计数器均如此），
+ * 被记录的对象在回滚前不能移动或销毁。同一对象可以重复记录，回滚后总是最早一次记录时的值。
+ * GameInfo::apply_operation等的带日志版本及Simulator::undo会自动记录各自修改的部分。
+ */
+class Undo_log {
+    public:
+    // 当前位置，回滚到此处即撤销此后记录的全部修改
+    int mark() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    // 已记录的字节数
+    size_t bytes() const { return data.size(); }
+
+    template<typename T>
+    void save(T& obj) {
+        static_assert(std::is_trivially_copyable_v<T>, "Undo_log can only save trivially copyable objects");
+        save_bytes(&obj, sizeof(T));
+    }
+    // Fixed_vector只记录计数及已使用的元素
+    template<typename T, int N>
+    void save(Fixed_vector<T, N>& v) {
+        save_bytes(&v.count, sizeof(v.count));
+        save_bytes(v.data(), v.size() * sizeof(T));
+    }
+
+    // 撤销mark之后的全部修改
+    void rollback(int mark) {
+        for (int i = entries.size() - 1; i >= mark; i--) {
+            const Entry& e = entries[i];
+            std::memcpy(e.addr, data.data() + e.offset, e.size);
+        }
+        if (mark < (int)entries.size()) data.resize(entries[mark].offset);
+        entries.resize(mark);
+    }
+    void clear() {
+        entries.clear();
+        data.clear();
+    }
+
+    private:
+    struct Entry {
+        void* addr;
+        size_t size, offset;
+    };
+    std::vector<Entry> entries;
+    std::vector<unsigned char> data; // 各记录的原始字节依次拼接
+
+    void save_bytes(void* addr, size_t size) {
+        entries.push_back({addr, size, data.size()});
+        const unsigned char* p = static_cast<const unsigned char*>(addr);
+        data.insert(data.end(), p, p + size);
+    }
+};
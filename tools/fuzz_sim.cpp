@@ -0,0 +1,563 @@
+// 模拟器的差分测试：在随机局面上以随机操作同时推进Simulator与冻结的参考实现（include/reference.hpp），每回合比对操作检查结果、完整局面及计数器
+// 用法: fuzz_sim [-m 检查项] [-n 局面数] [-r 每个局面的回合数] [-s 种子] [-o 失配快照路径] [-x 重现的快照路径]
+// 检查项（默认all，即依次进行以下全部检查）：
+//   sim   Simulator与参考实现的比对，操作直接以Op_validator检查后执行（以下说明均指此项）
+//   task  同sim，但Simulator的操作经task_list及continue_simulation调度（即__add_op的路径），每回合比对完整局面及计数器
+//   undo  Simulator::mark后以随机操作推进若干回合再rollback，与mark前的副本比对（两层嵌套的mark）
+//   bitboard  Bitboard::neighbours_in及neighbours与按OFFSET逐点计算的结果比对（全部单点集合及各种子的随机集合）
+//   baseline  防守候选以Defence_baseline分叉评估与完整模拟评估比对（随机局面、Op_generator生成的候选及各种提前停止条件）
+// 偶数号局面按先手方（pid为0）的顺序推进，奇数号局面按后手方的顺序推进（同Simulator::step_simulation）
+// 出现失配时逐步缩减局面及操作，将最小的失配局面写入快照、其操作写入<快照路径>.ops，打印操作及差异，返回非零（见Makefile中的fuzz）
+// -x 读取以上两个文件并重新运行，用于修复后的验证
+
+#include "../include/simulate.hpp"
+#include "../include/operation.hpp"
+#include "../include/reference.hpp"
+#include "../include/snapshot.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// 一个测试用例：初始局面、推进顺序及此后各回合双方尝试的操作
+struct Fuzz_case {
+    GameInfo info{0};
+    int pid = 0; // 推进顺序，同Simulator::pid
+    std::vector<std::vector<Operation>> ops[2];
+
+    int rounds() const { return ops[0].size(); }
+};
+
+// 一次运行中的第一处失配
+struct Mismatch {
+    int round = -1; // 失配的回合（相对于用例开始），无失配时为-1
+    GameInfo before{0}; // 该回合开始时的局面（此前两者一致）
+    std::string report;
+};
+
+static std::string ops_str(const std::vector<Operation>& ops) {
+    std::string ans;
+    for (const Operation& op : ops) ans += ' ' + op.str(true);
+    return ans.empty() ? " (none)" : ans;
+}
+
+// 比对Simulator的ants_killed、old_ants及next_old
+template<typename Ref>
+static std::string counter_diff(const Ref& ref, const Simulator& sim) {
+    std::string ans;
+    for (int i = 0; i < 2; i++) {
+        if (ref.ants_killed[i] != sim.ants_killed[i]) ans += str_wrap("ants_killed[%d] %d->%d\n", i, ref.ants_killed[i], sim.ants_killed[i]);
+        if (ref.old_ants[i] != sim.old_ants[i]) ans += str_wrap("old_ants[%d] %d->%d\n", i, ref.old_ants[i], sim.old_ants[i]);
+        if (ref.next_old[i] != sim.next_old[i]) ans += str_wrap("next_old[%d] %d->%d\n", i, ref.next_old[i], sim.next_old[i]);
+    }
+    return ans;
+}
+
+/**
+ * @brief 运行用例并比对。推进顺序与Simulator::step_simulation一致，操作不经task_list，而是直接以Op_validator::append逐个检查，
+ * 以便比对每回合被接受的操作（task_list的调度见run_task_case）
+ * @return Mismatch 第一处失配
+ */
+static Mismatch run_case(const Fuzz_case& c) {
+    Mismatch m;
+    Simulator sim(c.info, c.pid);
+    reference::Simulator ref(sim.info); // Simulator会重置基地血量，从其局面开始
+    for (int r = 0; r < c.rounds(); r++) {
+        GameInfo before = sim.info;
+        std::string report;
+        auto play = [&](int p) {
+            Op_validator validator(sim.info, p);
+            for (const Operation& op : c.ops[p][r]) if (validator.append(op)) sim.operations[p].push_back(op);
+            sim.apply_operations_of_player(p);
+            std::vector<Operation> accepted = ref.play(p, c.ops[p][r]);
+            if (ops_str(accepted) != ops_str(sim.operations[p]))
+                report += str_wrap("player %d accepted:%s\n  reference accepted:%s\n", p, ops_str(sim.operations[p]).c_str(), ops_str(accepted).c_str());
+        };
+        auto settle = [&]() {
+            bool running = sim.next_round();
+            if (running != ref.next_round()) report += "game end differs\n";
+            report += counter_diff(ref, sim);
+            return running;
+        };
+        bool running;
+        if (c.pid == 0) {
+            play(0);
+            play(1);
+            running = settle();
+        } else {
+            play(1);
+            running = settle();
+            if (running) play(0);
+        }
+        report += reference::full_diff(ref.info, sim.info);
+        if (!report.empty()) {
+            m.round = r;
+            m.before = before;
+            m.report = report;
+            return m;
+        }
+        if (!running) break;
+    }
+    return m;
+}
+
+/**
+ * @brief 任务调度的检查：随机操作作为各回合的任务放入task_list，Simulator以start_simulation及continue_simulation逐回合推进，
+ * 参考实现按__add_op的顺序执行同样的操作：start_simulation将降级操作稳定地排到最后，__add_op从后往前取出当回合的任务，
+ * 即先逆序执行降级，再逆序执行其余操作。每回合比对完整局面及计数器
+ * @return std::string 差异报告，无差异时为空
+ */
+static std::string run_task_case(unsigned long long seed, int pid, int rounds) {
+    reference::State_generator gen(seed);
+    Simulator sim(gen.generate(), pid);
+    reference::Simulator ref(sim.info); // Simulator会重置基地血量，从其局面开始
+    auto scheduled = [](const std::vector<Operation>& ops) {
+        std::vector<Operation> ans;
+        for (auto it = ops.rbegin(); it != ops.rend(); ++it) if (it->type == DowngradeTower) ans.push_back(*it);
+        for (auto it = ops.rbegin(); it != ops.rend(); ++it) if (it->type != DowngradeTower) ans.push_back(*it);
+        return ans;
+    };
+
+    // 操作依赖于推进中的局面，先以参考实现推进并记录各回合后的参考实现
+    std::vector<reference::Simulator> expected;
+    std::vector<std::string> round_ops;
+    for (int r = 0; r < rounds; r++) {
+        std::string ops_desc;
+        auto play = [&](int p) {
+            std::vector<Operation> ops = gen.operations(ref.info, p);
+            for (const Operation& op : ops) sim.task_list[p].emplace_back(op, r);
+            ref.play(p, scheduled(ops));
+            ops_desc += str_wrap(" player %d:%s", p, ops_str(ops).c_str());
+        };
+        bool running;
+        if (pid == 0) {
+            play(0);
+            play(1);
+            running = ref.next_round();
+        } else {
+            play(1);
+            running = ref.next_round();
+            if (running) play(0);
+        }
+        expected.push_back(ref);
+        round_ops.push_back(ops_desc);
+        if (!running) break;
+    }
+
+    sim.start_simulation();
+    for (int r = 0; r < (int)expected.size(); r++) {
+        sim.continue_simulation(r + 1, -1);
+        std::string report = reference::full_diff(expected[r].info, sim.info) + counter_diff(expected[r], sim);
+        if (!report.empty()) return str_wrap("round %d, tasks%s\n", r, round_ops[r].c_str()) + report;
+    }
+    return "";
+}
+
+// 比对回滚后与mark前的Simulator：完整局面（含state_hash不覆盖的信息素、超级武器及其区域）及计数器
+static std::string rollback_diff(const Simulator& copy, const Simulator& sim) {
+    std::string ans = reference::full_diff(copy.info, sim.info);
+    if (state_hash(copy.info) != state_hash(sim.info)) ans += "state_hash differs\n";
+    for (int p = 0; p < 2; p++) for (int t = 0; t < EmergencyEvasion; t++)
+        if (copy.info.super_weapon_areas[p][t] != sim.info.super_weapon_areas[p][t]) ans += str_wrap("super_weapon_areas[%d][%d] differs\n", p, t);
+    return ans + counter_diff(copy, sim);
+}
+
+/**
+ * @brief 撤销日志的检查：mark后以随机操作推进rounds回合，再mark并推进rounds回合，依次回滚并与各自mark时的副本比对
+ * @return std::string 差异报告，无差异时为空
+ */
+static std::string run_undo_case(unsigned long long seed, int pid, int rounds) {
+    reference::State_generator gen(seed);
+    Undo_log log;
+    Simulator sim(gen.generate(), pid);
+    sim.undo = &log;
+    auto advance = [&](int n) {
+        auto play = [&](int p) {
+            Op_validator validator(sim.info, p);
+            for (const Operation& op : gen.operations(sim.info, p)) if (validator.append(op)) sim.operations[p].push_back(op);
+            sim.apply_operations_of_player(p);
+            sim.operations[p].clear();
+        };
+        for (int r = 0; r < n; r++) {
+            if (pid == 0) {
+                play(0);
+                play(1);
+                if (!sim.next_round()) return;
+            } else {
+                play(1);
+                if (!sim.next_round()) return;
+                play(0);
+            }
+        }
+    };
+
+    std::string report;
+    Simulator outer(sim);
+    outer.undo = nullptr;
+    int outer_mark = sim.mark();
+    advance(rounds);
+    Simulator inner(sim);
+    inner.undo = nullptr;
+    int inner_mark = sim.mark();
+    advance(rounds);
+    sim.rollback(inner_mark);
+    if (std::string diff = rollback_diff(inner, sim); !diff.empty()) report += "inner rollback:\n" + diff;
+    sim.rollback(outer_mark);
+    if (std::string diff = rollback_diff(outer, sim); !diff.empty()) report += "outer rollback:\n" + diff;
+    if (!log.empty()) report += "undo log not empty after rollback\n";
+    return report;
+}
+
+// 按OFFSET逐点计算set中各点在direction方向上（不超出MAP_SIZE * MAP_SIZE网格）的相邻点
+static Cell_set neighbours_by_offset(const Cell_set& set, int direction) {
+    Cell_set ans;
+    for (int c : set) {
+        int x = cell_x(c), y = cell_y(c);
+        int nx = x + OFFSET[y % 2][direction][0], ny = y + OFFSET[y % 2][direction][1];
+        if (nx >= 0 && nx < MAP_SIZE && ny >= 0 && ny < MAP_SIZE) ans.set(cell_index(nx, ny));
+    }
+    return ans;
+}
+
+// 比对set的neighbours_in(0..5)及neighbours与逐点计算的结果
+static std::string neighbour_diff(const Cell_set& set) {
+    std::string ans;
+    Cell_set all;
+    for (int d = 0; d < 6; d++) {
+        Cell_set expected = neighbours_by_offset(set, d);
+        all |= expected;
+        Cell_set got = set.neighbours_in(d);
+        if (got == expected) continue;
+        ans += str_wrap("direction %d:", d);
+        for (int c : got ^ expected) ans += str_wrap(" (%d,%d)%s", cell_x(c), cell_y(c), got.test(c) ? "+" : "-");
+        ans += '\n';
+    }
+    if (set.neighbours() != all) ans += "neighbours differs from the union of directions\n";
+    return ans;
+}
+
+// 相邻点的检查：全部单点集合，即每个点的每个方向，覆盖网格边缘及两种奇偶行
+static std::string run_bitboard_singles() {
+    for (int c = 0; c < Cell_set::SIZE; c++) {
+        Cell_set single;
+        single.set(c);
+        if (std::string diff = neighbour_diff(single); !diff.empty()) return str_wrap("single (%d,%d):\n", cell_x(c), cell_y(c)) + diff;
+    }
+    return "";
+}
+
+/**
+ * @brief 相邻点的检查：种子对应的若干不同密度的随机集合
+ * @return std::string 差异报告，无差异时为空
+ */
+static std::string run_bitboard_case(unsigned long long seed) {
+    std::mt19937_64 rng(seed);
+    std::string report;
+    for (int k = 0; k < 8 && report.empty(); k++) {
+        Cell_set set;
+        double density = std::uniform_real_distribution<double>(0, 1)(rng);
+        for (int c = 0; c < Cell_set::SIZE; c++) if (std::bernoulli_distribution(density)(rng)) set.set(c);
+        if (std::string diff = neighbour_diff(set); !diff.empty()) report = str_wrap("random set %d (density %.2f):\n", k, density) + diff;
+    }
+    return report;
+}
+
+// 比对两个模拟结果的全部字段
+static std::string result_diff(const Sim_result& full, const Sim_result& fork) {
+    std::string ans;
+    auto field = [&](const char* name, int a, int b) {
+        if (a != b) ans += str_wrap(" %s %d->%d", name, a, b);
+    };
+    field("succ_ant", full.succ_ant, fork.succ_ant);
+    field("first_succ", full.first_succ, fork.first_succ);
+    field("danger_encounter", full.danger_encounter, fork.danger_encounter);
+    field("first_enc", full.first_enc, fork.first_enc);
+    field("old_ant", full.old_ant, fork.old_ant);
+    field("next_old", full.next_old, fork.next_old);
+    field("dmg_dealt", full.dmg_dealt, fork.dmg_dealt);
+    field("dmg_time", full.dmg_time, fork.dmg_time);
+    field("old_opp", full.old_opp, fork.old_opp);
+    field("next_old_opp", full.next_old_opp, fork.next_old_opp);
+    field("early_stop", full.early_stop, fork.early_stop);
+    return ans;
+}
+
+/**
+ * @brief 基准轨迹的检查：在随机局面上按AI的配置（aware/peace的建塔搜索，有时带LS）生成防守候选，
+ * 以Operation_list::evaluate分别完整模拟及从Defence_baseline分叉评估，比对结果。
+ * 提前停止条件取不停止、不操作时的first_succ、此前候选的最大first_succ或随机值，覆盖分叉回合的各项来源
+ * @param info 若返回非空，则为失配的局面
+ * @return std::string 差异报告，无差异时为空
+ */
+static std::string run_baseline_case(unsigned long long seed, int pid, GameInfo& info) {
+    reference::State_generator gen(seed);
+    std::mt19937_64 rng(seed);
+    auto uniform = [&](int l, int r) { return std::uniform_int_distribution<int>(l, r)(rng); };
+    info = gen.generate();
+    Game_context ctx;
+    ctx.pid = pid;
+    ctx.info = &info;
+    const int sim_round = info.round < 150 ? 70 + info.round / 3 : 120; // 同AI的get_sim_round
+
+    Op_generator build_gen(info, pid);
+    switch (uniform(0, 2)) {
+        case 0: break; // aware
+        case 1: build_gen << Sell_cfg{3, 3} << LS_cfg{true}; break; // aware（警戒）
+        case 2: // peace
+            build_gen.sell.tweaking = true;
+            build_gen.build.lv3_options.clear();
+            build_gen.upgrade.max_count = 1;
+            break;
+    }
+    build_gen.generate_operations();
+    Defence_baseline baseline(ctx, sim_round);
+
+    Operation_list raw(ctx, {}, -1, 0, 0, !pid);
+    raw.evaluate(sim_round);
+    int best_first_succ = raw.res.first_succ;
+    std::vector<int> order(build_gen.ops.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    if (order.size() > 16) order.resize(16);
+    for (int i : order) {
+        const Defense_operation& op_list = build_gen.ops[i];
+        int stopping_f_succ = -1;
+        switch (uniform(0, 3)) {
+            case 0: break;
+            case 1: stopping_f_succ = raw.res.first_succ; break;
+            case 2: stopping_f_succ = best_first_succ; break;
+            case 3: stopping_f_succ = uniform(0, sim_round); break;
+        }
+        Operation_list full(ctx, {}, -1, 0, 0, !pid), fork(ctx, {}, -1, 0, 0, !pid);
+        full.ops = fork.ops = op_list.ops;
+        full.evaluate(sim_round, stopping_f_succ);
+        fork.evaluate(sim_round, stopping_f_succ, &baseline);
+        best_first_succ = std::max(best_first_succ, full.res.first_succ);
+        if (std::string diff = result_diff(full.res, fork.res); !diff.empty()) {
+            std::string ops;
+            for (const Task& t : op_list.ops) ops += ' ' + t.op.str(true) + str_wrap("(+%d)", t.round);
+            return str_wrap("candidate%s, %d rounds, stopping_f_succ %d:%s\n", ops.c_str(), sim_round, stopping_f_succ, diff.c_str());
+        }
+    }
+    return "";
+}
+
+// 以失配回合开始时的局面为起点，再逐个尝试删除蚂蚁、塔、超级武器及操作，保留仍然失配的结果，直至无法再缩减
+static Fuzz_case shrink(Fuzz_case c, Mismatch& m) {
+    Fuzz_case head;
+    head.info = m.before;
+    head.pid = c.pid;
+    for (int p = 0; p < 2; p++) head.ops[p] = {c.ops[p][m.round]};
+    if (Mismatch hm = run_case(head); hm.round >= 0) {
+        c = head;
+        m = hm;
+    }
+
+    auto try_case = [&](const Fuzz_case& cand) {
+        Mismatch cm = run_case(cand);
+        if (cm.round < 0) return false;
+        c = cand;
+        m = cm;
+        return true;
+    };
+    for (bool progress = true; progress; ) {
+        progress = false;
+        for (int i = c.info.ants.size() - 1; i >= 0; i--) {
+            Fuzz_case cand = c;
+            cand.info.ants.erase(cand.info.ants.begin() + i);
+            progress |= try_case(cand);
+        }
+        for (int i = c.info.towers.size() - 1; i >= 0; i--) {
+            Fuzz_case cand = c;
+            cand.info.towers.erase(cand.info.towers.begin() + i);
+            progress |= try_case(cand);
+        }
+        for (int i = c.info.super_weapons.size() - 1; i >= 0; i--) {
+            Fuzz_case cand = c;
+            cand.info.super_weapons.erase(cand.info.super_weapons.begin() + i);
+            cand.info.update_super_weapon_areas();
+            progress |= try_case(cand);
+        }
+        for (int p = 0; p < 2; p++) for (int r = c.rounds() - 1; r >= 0; r--) for (int i = c.ops[p][r].size() - 1; i >= 0; i--) {
+            Fuzz_case cand = c;
+            cand.ops[p][r].erase(cand.ops[p][r].begin() + i);
+            progress |= try_case(cand);
+        }
+        // 去掉失配之后的回合
+        if (c.rounds() > m.round + 1) {
+            for (int p = 0; p < 2; p++) c.ops[p].resize(m.round + 1);
+            progress = true;
+        }
+    }
+    return c;
+}
+
+// 操作文件：首行为“pid 回合数”，此后每个操作一行“回合 玩家 类型 arg0 arg1”
+static bool save_ops(const Fuzz_case& c, const std::string& path) {
+    std::FILE* fout = std::fopen(path.c_str(), "w");
+    if (!fout) return false;
+    std::fprintf(fout, "%d %d\n", c.pid, c.rounds());
+    for (int r = 0; r < c.rounds(); r++) for (int p = 0; p < 2; p++)
+        for (const Operation& op : c.ops[p][r]) std::fprintf(fout, "%d %d %d %d %d\n", r, p, op.type, op.arg0, op.arg1);
+    return std::fclose(fout) == 0;
+}
+
+// 读取save_snapshot及save_ops写入的用例
+static bool load_case(const std::string& path, Fuzz_case& c) {
+    std::FILE* fin = std::fopen(path.c_str(), "rb");
+    if (!fin) return false;
+    std::vector<uint64_t> data; // 以uint64_t保证快照的对齐
+    std::string bytes;
+    char buf[4096];
+    for (size_t n; (n = std::fread(buf, 1, sizeof(buf), fin)) > 0; ) bytes.append(buf, n);
+    std::fclose(fin);
+    data.resize((bytes.size() + 7) / 8);
+    std::memcpy(data.data(), bytes.data(), bytes.size());
+    Snapshot_view view;
+    std::string err;
+    if (!view.attach(data.data(), bytes.size(), err)) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), err.c_str());
+        return false;
+    }
+    c.info = view.restore();
+
+    fin = std::fopen((path + ".ops").c_str(), "r");
+    if (!fin) return false;
+    int rounds = 0;
+    bool ok = std::fscanf(fin, "%d %d", &c.pid, &rounds) == 2 && rounds >= 0;
+    for (int p = 0; p < 2; p++) c.ops[p].assign(rounds, {});
+    for (int r, p, type, arg0, arg1; ok && std::fscanf(fin, "%d %d %d %d %d", &r, &p, &type, &arg0, &arg1) == 5; ) {
+        if (r < 0 || r >= rounds || p < 0 || p > 1) ok = false;
+        else c.ops[p][r].emplace_back(static_cast<OperationType>(type), arg0, arg1);
+    }
+    std::fclose(fin);
+    return ok;
+}
+
+static void print_mismatch(const Fuzz_case& c, const Mismatch& m) {
+    for (int r = 0; r < c.rounds(); r++) for (int p = 0; p < 2; p++)
+        printf("round %d player %d ops:%s\n", r, p, ops_str(c.ops[p][r]).c_str());
+    printf("pid %d, towers %zu, ants %zu, super weapons %zu; mismatch at round %d:\n%s",
+        c.pid, c.info.towers.size(), c.info.ants.size(), c.info.super_weapons.size(), m.round, m.report.c_str());
+}
+
+int main(int argc, char** argv) {
+    int cases = 200, rounds = 30;
+    unsigned long long seed = 1;
+    std::string mode = "all", out = "fuzz_mismatch.snap", replay;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-m" && i + 1 < argc) mode = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) cases = std::stoi(argv[++i]);
+        else if (arg == "-r" && i + 1 < argc) rounds = std::stoi(argv[++i]);
+        else if (arg == "-s" && i + 1 < argc) seed = std::stoull(argv[++i]);
+        else if (arg == "-o" && i + 1 < argc) out = argv[++i];
+        else if (arg == "-x" && i + 1 < argc) replay = argv[++i];
+        else {
+            fprintf(stderr, "usage: fuzz_sim [-m all|sim|task|undo|bitboard|baseline] [-n cases] [-r rounds] [-s seed] [-o snapshot] [-x snapshot]\n");
+            return 2;
+        }
+    }
+    if (mode != "all" && mode != "sim" && mode != "task" && mode != "undo" && mode != "bitboard" && mode != "baseline") {
+        fprintf(stderr, "unknown check %s\n", mode.c_str());
+        return 2;
+    }
+    init_dist_array();
+
+    if (!replay.empty()) {
+        Fuzz_case c;
+        if (!load_case(replay, c)) {
+            fprintf(stderr, "cannot load %s and %s.ops\n", replay.c_str(), replay.c_str());
+            return 2;
+        }
+        Mismatch m = run_case(c);
+        if (m.round < 0) {
+            printf("%s: no mismatch\n", replay.c_str());
+            return 0;
+        }
+        print_mismatch(c, m);
+        return 1;
+    }
+
+    if (mode == "all" || mode == "task") {
+        for (int k = 0; k < cases; k++) {
+            std::string report = run_task_case(seed + k, k % 2, rounds);
+            if (report.empty()) continue;
+            printf("task case %d (seed %llu, pid %d): scheduled simulation differs from the reference\n%s", k, seed + k, k % 2, report.c_str());
+            return 1;
+        }
+        printf("task: %d cases x %d rounds: no mismatch\n", cases, rounds);
+    }
+    if (mode == "all" || mode == "undo") {
+        for (int k = 0; k < cases; k++) {
+            std::string report = run_undo_case(seed + k, k % 2, rounds / 2);
+            if (report.empty()) continue;
+            printf("undo case %d (seed %llu, pid %d): rollback differs from the state at mark\n%s", k, seed + k, k % 2, report.c_str());
+            return 1;
+        }
+        printf("undo: %d cases x 2 x %d rounds: no mismatch\n", cases, rounds / 2);
+    }
+    if (mode == "all" || mode == "bitboard") {
+        if (std::string report = run_bitboard_singles(); !report.empty()) {
+            printf("bitboard: neighbours differ from OFFSET\n%s", report.c_str());
+            return 1;
+        }
+        for (int k = 0; k < cases; k++) {
+            std::string report = run_bitboard_case(seed + k);
+            if (report.empty()) continue;
+            printf("bitboard case %d (seed %llu): neighbours differ from OFFSET\n%s", k, seed + k, report.c_str());
+            return 1;
+        }
+        printf("bitboard: %d cases: no mismatch\n", cases);
+    }
+    if (mode == "all" || mode == "baseline") {
+        for (int k = 0; k < cases; k++) {
+            GameInfo info(0);
+            std::string report = run_baseline_case(seed + k, k % 2, info);
+            if (report.empty()) continue;
+            printf("baseline case %d (seed %llu, pid %d): forked evaluation differs from full simulation\n%s", k, seed + k, k % 2, report.c_str());
+            if (save_snapshot(info, out)) printf("state saved to %s\n", out.c_str());
+            return 1;
+        }
+        printf("baseline: %d cases: no mismatch\n", cases);
+    }
+    if (mode != "all" && mode != "sim") return 0;
+
+    for (int k = 0; k < cases; k++) {
+        reference::State_generator gen(seed + k);
+        Fuzz_case c;
+        c.info = gen.generate();
+        c.pid = k % 2;
+        // 操作依赖于推进中的局面，以参考实现按同样的顺序推进来生成
+        reference::Simulator ref(c.info);
+        auto play = [&](int p) {
+            c.ops[p].push_back(gen.operations(ref.info, p));
+            ref.play(p, c.ops[p].back());
+        };
+        for (int r = 0; r < rounds && ref.info.round < MAX_ROUND; r++) {
+            if (c.pid == 0) {
+                play(0);
+                play(1);
+                ref.next_round();
+            } else {
+                play(1);
+                if (ref.next_round()) play(0);
+                else c.ops[0].emplace_back();
+            }
+        }
+
+        Mismatch m = run_case(c);
+        if (m.round < 0) continue;
+        printf("case %d (seed %llu): mismatch at round %d of %d, shrinking...\n", k, seed + k, m.round, c.rounds());
+        fflush(stdout);
+        c = shrink(c, m);
+        print_mismatch(c, m);
+        if (save_snapshot(c.info, out) && save_ops(c, out + ".ops"))
+            printf("initial state saved to %s, operations to %s.ops (rerun with -x %s)\n", out.c_str(), out.c_str(), out.c_str());
+        return 1;
+    }
+    printf("%d cases x %d rounds: no mismatch\n", cases, rounds);
+    return 0;
+}
@@ -0,0 +1,290 @@
+// 本地评测器：通过管道启动两个AI进程，以Simulator的规则代码作为权威规则进行完整对局
+// 用法: judger [-n 局数] [-j 并行数] [-s 起始种子] [-t 每回合时限(ms)] [-r 回放目录] [-l 日志目录] [-c 输入录制目录] [-p] AI0 AI1
+//   -p 在回放中记录信息素；AI以"/bin/sh -c"启动，可带参数
+//   -c 将发给每个AI的全部输入录制为<目录>/<局号>_p<先后手>.in，AI的决策确定时，以之重定向stdin即可重现该局（见tools/pgo_bench.cpp）
+// 第i局使用种子(起始种子+i)，奇数局交换双方的先后手
+// 仅支持POSIX系统
+
+#include "../include/referee.hpp"
+#include "../include/replay.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// 评测配置
+struct Judger_cfg {
+    std::string cmd[2];
+    int games = 1;
+    int jobs = 1;
+    unsigned long long seed = 0;
+    int time_limit = 1000; // 每回合时限(ms)
+    std::string replay_dir;
+    std::string log_dir;
+    std::string capture_dir;
+    bool record_pheromone = false;
+};
+
+// 通过管道与之通信的AI进程
+class Child {
+    public:
+    enum Status { OK, TIMEOUT, CLOSED, MALFORMED };
+
+    ~Child() { stop(); }
+
+    /**
+     * @brief 启动进程
+     * @param cmd 启动命令
+     * @param err_path 进程stderr的重定向目标
+     * @param capture_path 若非空，将发给进程的全部输入录制于此
+     * @return bool 是否启动成功
+     */
+    bool start(const std::string& cmd, const std::string& err_path, const std::string& capture_path = "") {
+        if (!capture_path.empty()) capture = std::fopen(capture_path.c_str(), "wbe");
+        // 多局并行时其它线程可能随时fork，管道须在创建时即带有O_CLOEXEC，以免泄漏给其它AI进程；dup2得到的标准输入输出不带此标志
+        int in_pipe[2], out_pipe[2];
+        if (pipe2(in_pipe, O_CLOEXEC) || pipe2(out_pipe, O_CLOEXEC)) return false;
+        const std::string shell_cmd = "exec " + cmd; // fork后的子进程中不宜分配内存
+        pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            dup2(in_pipe[0], STDIN_FILENO);
+            dup2(out_pipe[1], STDOUT_FILENO);
+            int err_fd = open(err_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (err_fd >= 0) dup2(err_fd, STDERR_FILENO);
+            for (int fd : {in_pipe[0], in_pipe[1], out_pipe[0], out_pipe[1], err_fd}) if (fd > STDERR_FILENO) close(fd);
+            execl("/bin/sh", "sh", "-c", shell_cmd.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        close(in_pipe[0]);
+        close(out_pipe[1]);
+        in_fd = in_pipe[1];
+        out_fd = out_pipe[0];
+        return true;
+    }
+
+    bool send(const std::string& msg) {
+        if (capture) std::fwrite(msg.data(), 1, msg.size(), capture);
+        size_t done = 0;
+        while (done < msg.size()) {
+            ssize_t n = write(in_fd, msg.data() + done, msg.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 读取一次完整的回复（4字节大端长度头+正文）
+     * @param payload 回复的正文
+     * @param timeout_ms 时限(ms)
+     * @param used_ms 实际用时(ms)
+     * @return Status 读取结果
+     */
+    Status recv(std::string& payload, int timeout_ms, double& used_ms) {
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = [&]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+        unsigned char header[4];
+        Status st = read_exact(header, 4, timeout_ms, elapsed);
+        if (st == OK) {
+            unsigned len = (unsigned)header[0] << 24 | (unsigned)header[1] << 16 | (unsigned)header[2] << 8 | header[3];
+            if (len > (1u << 20)) st = MALFORMED;
+            else {
+                payload.assign(len, '\0');
+                st = read_exact(&payload[0], len, timeout_ms, elapsed);
+            }
+        }
+        used_ms = elapsed();
+        return st;
+    }
+
+    void stop() {
+        if (in_fd >= 0) close(in_fd);
+        if (out_fd >= 0) close(out_fd);
+        in_fd = out_fd = -1;
+        if (capture) std::fclose(capture);
+        capture = nullptr;
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        pid = -1;
+    }
+
+    private:
+    pid_t pid = -1;
+    int in_fd = -1; // 写入子进程stdin
+    int out_fd = -1; // 读取子进程stdout
+    std::FILE* capture = nullptr; // 输入录制
+
+    template<typename Clock>
+    Status read_exact(void* buf, size_t len, int timeout_ms, Clock elapsed) {
+        size_t done = 0;
+        while (done < len) {
+            int remain = timeout_ms - (int)elapsed();
+            if (remain <= 0) return TIMEOUT;
+            pollfd pfd{out_fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, remain);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready == 0) return TIMEOUT;
+            ssize_t n = read(out_fd, (char*)buf + done, len - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return CLOSED;
+            done += n;
+        }
+        return OK;
+    }
+};
+
+// 单局结果，其中的下标均为AI编号（而非先后手）
+struct Match_result {
+    int seed;
+    int winner = -1; // 获胜的AI编号，平局为-1
+    std::string reason;
+    int rounds = 0;
+    int hp[2] = {}, kills[2] = {};
+    std::vector<double> latency[2]; // 每次决策的用时(ms)
+};
+
+static Match_result run_match(const Judger_cfg& cfg, int game_id) {
+    Match_result result;
+    result.seed = cfg.seed + game_id;
+    int ai_of[2] = {game_id % 2, !(game_id % 2)}; // ai_of[player]: 该位置上的AI编号
+
+    Referee ref(result.seed);
+    Replay_writer replay(result.seed);
+    Child child[2];
+    for (int p = 0; p < 2; p++) {
+        std::string err_path = cfg.log_dir.empty() ? "/dev/null" : str_wrap("%s/%d_p%d.err", cfg.log_dir.c_str(), game_id, p);
+        std::string capture_path = cfg.capture_dir.empty() ? "" : str_wrap("%s/%d_p%d.in", cfg.capture_dir.c_str(), game_id, p);
+        if (!child[p].start(cfg.cmd[ai_of[p]], err_path, capture_path) || !child[p].send(str_wrap("%d %d\n", p, result.seed)))
+            ref.forfeit(p, "failed to start");
+    }
+
+    std::vector<Operation> ops[2];
+    while (!ref.finished) {
+        for (int p = 0; p < 2 && !ref.finished; p++) {
+            if (p == 1 && !child[1].send(serialize_operations(ops[0]))) {
+                ref.forfeit(1, "pipe closed");
+                break;
+            }
+            std::string payload;
+            double used;
+            Child::Status st = child[p].recv(payload, cfg.time_limit, used);
+            result.latency[ai_of[p]].push_back(used);
+            if (st != Child::OK) {
+                ref.forfeit(p, st == Child::TIMEOUT ? str_wrap("timeout at round %d", ref.info().round) :
+                               st == Child::CLOSED ? std::string("process exited") : std::string("malformed output"));
+                break;
+            }
+            std::istringstream in(payload);
+            ops[p] = read_opponent_operations(in);
+            if (!in) {
+                ref.forfeit(p, "malformed output");
+                break;
+            }
+            ref.apply_operations(p, ops[p]);
+        }
+        if (ref.finished) break;
+
+        ref.settle();
+        RoundInfo info = ref.round_info();
+        replay.add_round(ops, info, cfg.record_pheromone ? ref.info().pheromone : nullptr);
+        if (ref.finished) break;
+
+        std::string round_msg = serialize_round_info(info);
+        bool ok0 = child[0].send(serialize_operations(ops[1]) + round_msg);
+        bool ok1 = child[1].send(round_msg);
+        if (!ok0) ref.forfeit(0, "pipe closed");
+        else if (!ok1) ref.forfeit(1, "pipe closed");
+    }
+    for (Child& c : child) c.stop();
+
+    result.winner = ref.winner < 0 ? -1 : ai_of[ref.winner];
+    result.reason = ref.reason;
+    result.rounds = ref.info().round;
+    for (int p = 0; p < 2; p++) {
+        result.hp[ai_of[p]] = ref.info().bases[p].hp;
+        result.kills[ai_of[p]] = ref.kills[p];
+    }
+    if (!cfg.replay_dir.empty() && !replay.save(str_wrap("%s/%d.json", cfg.replay_dir.c_str(), game_id), ref.winner, ref.reason))
+        fprintf(stderr, "[w] failed to save replay of game %d\n", game_id);
+    return result;
+}
+
+static double percentile(std::vector<double>& v, double q) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, (size_t)(q * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+int main(int argc, char** argv) {
+    Judger_cfg cfg;
+    std::vector<std::string> cmds;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_val = i + 1 < argc;
+        if (arg == "-n" && has_val) cfg.games = std::stoi(argv[++i]);
+        else if (arg == "-j" && has_val) cfg.jobs = std::stoi(argv[++i]);
+        else if (arg == "-s" && has_val) cfg.seed = std::stoull(argv[++i]);
+        else if (arg == "-t" && has_val) cfg.time_limit = std::stoi(argv[++i]);
+        else if (arg == "-r" && has_val) cfg.replay_dir = argv[++i];
+        else if (arg == "-l" && has_val) cfg.log_dir = argv[++i];
+        else if (arg == "-c" && has_val) cfg.capture_dir = argv[++i];
+        else if (arg == "-p") cfg.record_pheromone = true;
+        else cmds.push_back(arg);
+    }
+    if (cmds.size() != 2) {
+        fprintf(stderr, "usage: judger [-n games] [-j jobs] [-s seed] [-t time_limit_ms] [-r replay_dir] [-l log_dir] [-c capture_dir] [-p] AI0 AI1\n");
+        return 2;
+    }
+    cfg.cmd[0] = cmds[0], cfg.cmd[1] = cmds[1];
+    signal(SIGPIPE, SIG_IGN);
+    init_dist_array();
+
+    std::vector<Match_result> results(cfg.games);
+    std::atomic<int> next_game{0};
+    std::mutex print_mutex;
+    auto worker = [&]() {
+        for (int g; (g = next_game++) < cfg.games; ) {
+            results[g] = run_match(cfg, g);
+            const Match_result& r = results[g];
+            std::lock_guard<std::mutex> lock(print_mutex);
+            printf("game %3d seed %d: winner %2d, rounds %3d, hp %2d/%2d, kills %3d/%3d (%s)\n",
+                g, r.seed, r.winner, r.rounds, r.hp[0], r.hp[1], r.kills[0], r.kills[1], r.reason.c_str());
+            fflush(stdout);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < std::max(1, cfg.jobs); i++) pool.emplace_back(worker);
+    for (std::thread& t : pool) t.join();
+
+    // 汇总
+    int wins[2] = {}, draws = 0, timeouts[2] = {};
+    std::vector<double> latency[2];
+    for (const Match_result& r : results) {
+        if (r.winner < 0) draws++;
+        else wins[r.winner]++;
+        for (int i = 0; i < 2; i++) {
+            latency[i].insert(latency[i].end(), r.latency[i].begin(), r.latency[i].end());
+            if (r.winner == !i && r.reason.find("timeout") != std::string::npos) timeouts[i]++;
+        }
+    }
+    printf("Summary: %d games, draws %d\n", cfg.games, draws);
+    for (int i = 0; i < 2; i++) {
+        double max_latency = latency[i].empty() ? 0 : *std::max_element(latency[i].begin(), latency[i].end());
+        printf("AI%d %s: wins %d, timeouts %d, latency(ms) p50 %.1lf p90 %.1lf p99 %.1lf max %.1lf\n", i, cfg.cmd[i].c_str(), wins[i], timeouts[i],
+            percentile(latency[i], 0.5), percentile(latency[i], 0.9), percentile(latency[i], 0.99), max_latency);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+// 录制输入的重放驱动：将judger -c录制的输入逐个重定向为AI进程的stdin，统计各AI重放全部输入的墙钟时间
+// 用法: pgo_bench [-r 重复次数] 输入文件或目录 AI [AI ...]
+//   目录中读取全部.in文件；AI以"/bin/sh -c"启动，可带参数；有多个AI时报告相对第一个AI的加速比
+// 既用于PGO的训练运行（此时只给出插桩版本），也用于比较PGO前后的速度（见Makefile中的pgo、pgo-bench）
+// 仅支持POSIX系统
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// 以input为stdin运行一次cmd，返回是否正常退出
+static bool run_once(const std::string& cmd, const std::string& input) {
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int in_fd = open(input.c_str(), O_RDONLY);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (in_fd < 0 || null_fd < 0) _exit(127);
+        dup2(in_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(in_fd);
+        close(null_fd);
+        execl("/bin/sh", "sh", "-c", ("exec " + cmd).c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char** argv) {
+    int repeats = 1;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc) repeats = std::max(1, std::stoi(argv[++i]));
+        else args.push_back(arg);
+    }
+    if (args.size() < 2) {
+        fprintf(stderr, "usage: pgo_bench [-r repeats] input_file_or_dir AI [AI ...]\n");
+        return 2;
+    }
+
+    std::vector<std::string> files;
+    if (std::filesystem::is_directory(args[0])) {
+        for (const auto& entry : std::filesystem::directory_iterator(args[0]))
+            if (entry.path().extension() == ".in") files.push_back(entry.path().string());
+    } else files.push_back(args[0]);
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        fprintf(stderr, "no input under %s\n", args[0].c_str());
+        return 1;
+    }
+
+    std::vector<double> seconds;
+    int failed = 0;
+    for (size_t k = 1; k < args.size(); k++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++) for (const std::string& f : files) {
+            if (run_once(args[k], f)) continue;
+            fprintf(stderr, "[w] %s exited abnormally on %s\n", args[k].c_str(), f.c_str());
+            failed++;
+        }
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        printf("%-24s %3zu inputs x %d: %8.2lfs", args[k].c_str(), files.size(), repeats, seconds.back());
+        if (k > 1) printf("  speed-up %.3lfx", seconds[0] / seconds.back());
+        printf("\n");
+        fflush(stdout);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+// 回放驱动的模拟器基准：逐回合把回放载入Controller，用Simulator::next_round预测下一回合并与回放比对
+// 用法: replay_bench [-v] [回放文件或目录 ...]，默认读取downloads/replay
+// 信息素决定蚂蚁的移动：回放既无种子又尚未给出信息素时，初始信息素未知，这些回合不比对蚂蚁
+
+#include "../include/control.hpp"
+#include "../include/simulate.hpp"
+#include "../include/replay.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+// 预测失配统计
+struct Fidelity_stat {
+    long long rounds = 0; // 比对的回合数
+    long long ant_rounds = 0; // 其中比对了蚂蚁的回合数
+    long long ant_miss = 0; // 蚂蚁不符的回合数
+    long long tower_miss = 0; // 塔不符的回合数
+    long long coin_miss = 0; // 金钱不符的回合数
+    long long hp_miss = 0; // 基地血量不符的回合数
+    double sim_seconds = 0; // Simulator构造及next_round的总耗时
+
+    Fidelity_stat& operator+=(const Fidelity_stat& other) {
+        rounds += other.rounds;
+        ant_rounds += other.ant_rounds;
+        ant_miss += other.ant_miss;
+        tower_miss += other.tower_miss;
+        coin_miss += other.coin_miss;
+        hp_miss += other.hp_miss;
+        sim_seconds += other.sim_seconds;
+        return *this;
+    }
+    std::string str() const {
+        return str_wrap("rounds %lld (ants compared in %lld), %.0lf rounds/s, mismatch ant/tower/coin/hp: %lld/%lld/%lld/%lld",
+            rounds, ant_rounds, sim_seconds > 0 ? rounds / sim_seconds : 0.0, ant_miss, tower_miss, coin_miss, hp_miss);
+    }
+};
+
+bool verbose = false;
+
+static std::string ants_str(const GameInfo& info) {
+    std::string ans;
+    for (const Ant& a : info.ants) ans += a.str(true);
+    return ans;
+}
+static std::string towers_str(const GameInfo& info) {
+    std::string ans;
+    for (const Tower& t : info.towers) ans += t.str(true);
+    return ans;
+}
+
+// 比对预测局面与回放局面，compare_ants为假时不比对蚂蚁
+static void compare(const GameInfo& pred, const GameInfo& real, bool compare_ants, Fidelity_stat& stat, const std::string& tag) {
+    stat.rounds++;
+    stat.ant_rounds += compare_ants;
+
+    bool ant_same = !compare_ants || pred.ants.size() == real.ants.size();
+    for (int i = 0; compare_ants && ant_same && i < (int)pred.ants.size(); i++) {
+        const Ant &p = pred.ants[i], &r = real.ants[i];
+        ant_same = p.id == r.id && p.x == r.x && p.y == r.y && p.hp == r.hp && p.age == r.age && p.level == r.level;
+    }
+    bool tower_same = pred.towers.size() == real.towers.size();
+    for (int i = 0; tower_same && i < (int)pred.towers.size(); i++) {
+        const Tower &p = pred.towers[i], &r = real.towers[i];
+        tower_same = p.id == r.id && p.player == r.player && p.x == r.x && p.y == r.y && p.type == r.type && p.cd == r.cd;
+    }
+    bool coin_same = pred.coins[0] == real.coins[0] && pred.coins[1] == real.coins[1];
+    bool hp_same = pred.bases[0].hp == real.bases[0].hp && pred.bases[1].hp == real.bases[1].hp;
+
+    stat.ant_miss += !ant_same;
+    stat.tower_miss += !tower_same;
+    stat.coin_miss += !coin_same;
+    stat.hp_miss += !hp_same;
+    if (!verbose) return;
+    if (!ant_same) fprintf(stderr, "%s ants differ\n  pred: %s\n  real: %s\n", tag.c_str(), ants_str(pred).c_str(), ants_str(real).c_str());
+    if (!tower_same) fprintf(stderr, "%s towers differ\n  pred: %s\n  real: %s\n", tag.c_str(), towers_str(pred).c_str(), towers_str(real).c_str());
+    if (!coin_same) fprintf(stderr, "%s coins differ: pred %d/%d real %d/%d\n", tag.c_str(), pred.coins[0], pred.coins[1], real.coins[0], real.coins[1]);
+    if (!hp_same) fprintf(stderr, "%s hp differ: pred %d/%d real %d/%d\n", tag.c_str(), pred.bases[0].hp, pred.bases[1].hp, real.bases[0].hp, real.bases[1].hp);
+}
+
+// 逐回合重放一局，站在player0的立场维护Controller
+static Fidelity_stat bench_replay(const Replay& rep) {
+    Fidelity_stat stat;
+    Controller c(InitInfo{0, rep.seed});
+    bool pheromone_known = rep.has_seed; // 此后由Controller维护，或由回放逐回合给出
+    if (!pheromone_known) fprintf(stderr, "[w] %s: no seed, ants are not compared until the replay gives pheromone\n", rep.name.c_str());
+
+    for (int r = 0; r < (int)rep.rounds.size(); r++) {
+        const Replay_round& rec = rep.rounds[r];
+        // 1) 双方操作
+        for (const Operation& op : rec.ops[0])
+            if (!c.append_self_operation(op)) fprintf(stderr, "%s round %d: invalid op0 %s\n", rep.name.c_str(), r, op.str(true).c_str());
+        c.apply_self_operations();
+        c.update_opponent_operations(rec.ops[1]);
+        c.apply_opponent_operations();
+
+        // 2) 预测
+        auto start = std::chrono::steady_clock::now();
+        Simulator sim(c.info, 0);
+        for (int i = 0; i < 2; i++) sim.info.bases[i].hp = c.info.bases[i].hp; // 以真实血量进行模拟
+        bool running = sim.next_round();
+        stat.sim_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!running) break;
+
+        // 3) 载入回放中的真实局面
+        RoundInfo state = rec.state;
+        c.update_round_info(state);
+        if (rec.has_pheromone) std::copy(&rec.pheromone[0][0][0], &rec.pheromone[0][0][0] + 2 * MAP_SIZE * MAP_SIZE, &c.info.pheromone[0][0][0]);
+        // 回放中不含Ant::evasion，沿用预测值
+        for (Ant& a : c.info.ants) {
+            int idx = sim.info.ant_of_id_by_index(a.id);
+            if (idx >= 0) a.evasion = sim.info.ants[idx].evasion;
+        }
+
+        compare(sim.info, c.info, pheromone_known, stat, str_wrap("%s round %d:", rep.name.c_str(), r));
+        pheromone_known |= rec.has_pheromone;
+        if (c.info.bases[0].hp <= 0 || c.info.bases[1].hp <= 0) break;
+    }
+    return stat;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "-v") verbose = true;
+        else inputs.push_back(argv[i]);
+    }
+    if (inputs.empty()) inputs.push_back("downloads/replay");
+
+    std::vector<std::string> files;
+    for (const std::string& in : inputs) {
+        if (std::filesystem::is_directory(in)) {
+            for (const auto& entry : std::filesystem::directory_iterator(in))
+                if (entry.path().extension() == ".json") files.push_back(entry.path().string());
+        } else files.push_back(in);
+    }
+    std::sort(files.begin(), files.end());
+
+    init_dist_array();
+    Fidelity_stat total;
+    int loaded = 0;
+    for (const std::string& file : files) {
+        std::string err;
+        std::optional<Replay> rep = load_replay(file, err);
+        if (!rep) {
+            fprintf(stderr, "[w] %s\n", err.c_str());
+            continue;
+        }
+        loaded++;
+        Fidelity_stat stat = bench_replay(rep.value());
+        printf("%s: %s\n", file.c_str(), stat.str().c_str());
+        total += stat;
+    }
+    printf("Total (%d replays): %s\n", loaded, total.str().c_str());
+    return loaded ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// 进程内批量自对弈：example/ai.cpp中的AI_与自身对局，不经过进程及管道
+// 用法: selfplay [-n 局数] [-j 线程数] [-s 起始种子] [-v]
+//   第i局使用种子(起始种子+i)，-v 打开AI的stderr日志
+// 输出按先后手汇总的胜负、血量、击杀统计及每次决策的用时分布
+
+#define AI_NO_MAIN
+#include "../example/ai.cpp"
+#include "../include/headless.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+static double percentile(std::vector<double>& v, double q) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, (size_t)(q * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+int main(int argc, char** argv) {
+    int games = 1, jobs = std::max(1u, std::thread::hardware_concurrency());
+    unsigned long long seed = 0;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_val = i + 1 < argc;
+        if (arg == "-n" && has_val) games = std::stoi(argv[++i]);
+        else if (arg == "-j" && has_val) jobs = std::stoi(argv[++i]);
+        else if (arg == "-s" && has_val) seed = std::stoull(argv[++i]);
+        else if (arg == "-v") verbose = true;
+        else {
+            fprintf(stderr, "usage: selfplay [-n games] [-j jobs] [-s seed] [-v]\n");
+            return 2;
+        }
+    }
+    init_dist_array();
+
+    std::vector<Headless_result> results(games);
+    std::atomic<int> next_game{0};
+    std::mutex print_mutex;
+    auto worker = [&]() {
+        for (int g; (g = next_game++) < games; ) {
+            AI_ ai0(!verbose), ai1(!verbose);
+            Headless_match<AI_> match(seed + g, ai0, ai1);
+            results[g] = match.run();
+            const Headless_result& r = results[g];
+            std::lock_guard<std::mutex> lock(print_mutex);
+            printf("game %4d seed %llu: winner %2d, rounds %3d, hp %2d/%2d, kills %3d/%3d (%s)\n",
+                g, r.seed, r.winner, r.rounds, r.hp[0], r.hp[1], r.kills[0], r.kills[1], r.reason.c_str());
+            fflush(stdout);
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < std::max(1, jobs); i++) pool.emplace_back(worker);
+    for (std::thread& t : pool) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 汇总
+    int wins[2] = {}, draws = 0;
+    long long hp[2] = {}, kills[2] = {};
+    std::vector<double> decision_ms[2];
+    for (const Headless_result& r : results) {
+        if (r.winner < 0) draws++;
+        else wins[r.winner]++;
+        for (int p = 0; p < 2; p++) {
+            hp[p] += r.hp[p];
+            kills[p] += r.kills[p];
+            decision_ms[p].insert(decision_ms[p].end(), r.decision_ms[p].begin(), r.decision_ms[p].end());
+        }
+    }
+    printf("Summary: %d games in %.1lfs (%.2lf games/s), draws %d\n", games, seconds, games / seconds, draws);
+    for (int p = 0; p < 2; p++) {
+        double max_ms = decision_ms[p].empty() ? 0 : *std::max_element(decision_ms[p].begin(), decision_ms[p].end());
+        printf("player%d: wins %d, avg hp %.2lf, avg kills %.2lf, decision(ms) p50 %.2lf p90 %.2lf p99 %.2lf max %.2lf\n",
+            p, wins[p], double(hp[p]) / std::max(1, games), double(kills[p]) / std::max(1, games),
+            percentile(decision_ms[p], 0.5), percentile(decision_ms[p], 0.9), percentile(decision_ms[p], 0.99), max_ms);
+    }
+    return 0;
+}